@@ -0,0 +1,252 @@
+#include "Benchmark.h"
+#include "Util.h"
+#include "ReplacerReader.h"
+#include "PoseIndex.h"
+
+#include <random>
+
+using namespace PAR;
+
+namespace
+{
+	float Percentile(std::vector<float>& a_samples, float a_pct)
+	{
+		if (a_samples.empty())
+			return 0.f;
+
+		const auto idx = static_cast<std::size_t>(a_pct * static_cast<float>(a_samples.size() - 1));
+		std::ranges::nth_element(a_samples, a_samples.begin() + idx);
+		return a_samples[idx];
+	}
+
+	float ToMicroseconds(std::chrono::nanoseconds a_cost)
+	{
+		return std::chrono::duration<float, std::micro>(a_cost).count();
+	}
+}
+
+bool Benchmark::Start(int a_frames, float a_maxFrameUs, float a_maxEvalUs)
+{
+	if (a_frames <= 0)
+		return false;
+
+	std::unique_lock lock{ _mutex };
+
+	if (_running)
+		return false;
+
+	_frameCosts.clear();
+	_evalCosts.clear();
+	_selections = 0;
+	_candidates = 0;
+	_evaluated = 0;
+	_replacers = 0;
+	_frameCosts.reserve(a_frames);
+
+	_target = a_frames;
+	_maxFrameUs = a_maxFrameUs;
+	_maxEvalUs = a_maxEvalUs;
+	_startMemory = Util::GetResidentMemory();
+
+	logger::info("benchmark started for {} frames", a_frames);
+
+	_running = true;
+	return true;
+}
+
+void Benchmark::RecordFrame(std::chrono::nanoseconds a_cost)
+{
+	if (!_running)
+		return;
+
+	std::unique_lock lock{ _mutex };
+	// the unlocked check only skips the lock while idle, Finish may have run in between
+	if (!_running)
+		return;
+
+	_frameCosts.push_back(ToMicroseconds(a_cost));
+
+	if (_frameCosts.size() >= static_cast<std::size_t>(_target)) {
+		Finish();
+	}
+}
+
+void Benchmark::RecordEvaluation(std::chrono::nanoseconds a_cost)
+{
+	if (!_running)
+		return;
+
+	std::unique_lock lock{ _mutex };
+	if (!_running)
+		return;
+
+	_evalCosts.push_back(ToMicroseconds(a_cost));
+}
+
+void Benchmark::RecordCandidates(std::size_t a_candidates, std::size_t a_evaluated, std::size_t a_total)
+{
+	if (!_running)
+		return;
+
+	std::unique_lock lock{ _mutex };
+	if (!_running)
+		return;
+
+	_selections += 1;
+	_candidates += a_candidates;
+	_evaluated += a_evaluated;
+	_replacers += a_total;
+}
+
+// must be called with _mutex held
+void Benchmark::Finish()
+{
+	_running = false;
+
+	const auto frames = _frameCosts.size();
+	const auto evals = _evalCosts.size();
+
+	const float frameP50 = Percentile(_frameCosts, 0.5f);
+	const float frameP99 = Percentile(_frameCosts, 0.99f);
+	const float evalP50 = Percentile(_evalCosts, 0.5f);
+	const float evalP99 = Percentile(_evalCosts, 0.99f);
+
+	const auto peak = Util::GetPeakResidentMemory();
+	const auto current = Util::GetResidentMemory();
+
+	logger::info("benchmark finished: {} frames, {} evaluations", frames, evals);
+	logger::info("  frame cost: p50 {:.1f}us, p99 {:.1f}us", frameP50, frameP99);
+	logger::info("  evaluation cost: p50 {:.1f}us, p99 {:.1f}us", evalP50, evalP99);
+	if (_selections) {
+		logger::info("  candidates per actor: {:.1f} of {:.1f} replacers",
+			static_cast<float>(_candidates) / static_cast<float>(_selections),
+			static_cast<float>(_replacers) / static_cast<float>(_selections));
+		logger::info("  conditions evaluated per actor: {:.1f}, {} candidate evaluations skipped",
+			static_cast<float>(_evaluated) / static_cast<float>(_selections),
+			_candidates - _evaluated);
+	}
+	logger::info("  memory: {} KiB at start, {} KiB at end, {} KiB high-water", _startMemory / 1024, current / 1024, peak / 1024);
+
+	if (_maxFrameUs > 0.f && frameP99 > _maxFrameUs) {
+		logger::error("benchmark regression: frame p99 {:.1f}us exceeds {:.1f}us", frameP99, _maxFrameUs);
+	}
+
+	if (_maxEvalUs > 0.f && evalP99 > _maxEvalUs) {
+		logger::error("benchmark regression: evaluation p99 {:.1f}us exceeds {:.1f}us", evalP99, _maxEvalUs);
+	}
+}
+
+
+void Benchmark::CompareLoaders(const std::string& a_file)
+{
+	std::thread([a_file]() {
+		constexpr int RUNS = 5;
+
+		const auto measure = [&a_file](const char* a_label, auto&& a_load) {
+			std::chrono::nanoseconds best = std::chrono::nanoseconds::max();
+			std::size_t retained = 0;
+			std::size_t peakGrowth = 0;
+
+			for (int i = 0; i < RUNS; ++i) {
+				const auto before = Util::GetResidentMemory();
+				const auto peakBefore = Util::GetPeakResidentMemory();
+				const auto start = std::chrono::steady_clock::now();
+
+				std::ifstream f{ a_file, std::ios::binary };
+				const auto data = a_load(f);
+
+				best = std::min(best, std::chrono::steady_clock::now() - start);
+
+				const auto after = Util::GetResidentMemory();
+				retained = std::max(retained, after > before ? after - before : 0);
+				peakGrowth = std::max(peakGrowth, Util::GetPeakResidentMemory() - peakBefore);
+
+				if (data.frames.empty() && data.limits.empty()) {
+					logger::info("loader benchmark: {} read nothing from {}", a_label, a_file);
+				}
+			}
+
+			logger::info("  {}: best of {} {:.2f}ms, {} KiB held after parsing, peak grew {} KiB",
+				a_label, RUNS, std::chrono::duration<float, std::milli>(best).count(), retained / 1024, peakGrowth / 1024);
+		};
+
+		std::error_code ec;
+		logger::info("loader benchmark on {} ({} KiB)", a_file, fs::file_size(a_file, ec) / 1024);
+
+		try {
+			// the streaming loader goes first, so the DOM can't lower its peak
+			measure("sax", [](std::istream& a_stream) { return ReplacerReader::Read(a_stream); });
+			measure("dom", [](std::istream& a_stream) { return json::parse(a_stream).get<ReplacerData>(); });
+		} catch (std::exception& e) {
+			logger::error("loader benchmark failed - {}", e.what());
+		}
+	}).detach();
+}
+
+void Benchmark::ComparePoseLookup(int a_frames, int a_keyBones)
+{
+	if (a_frames <= 0 || a_keyBones <= 0)
+		return;
+
+	std::thread([a_frames, a_keyBones]() {
+		constexpr int QUERIES = 1000;
+
+		std::mt19937 rng{ 0x50415221 };
+		std::uniform_real_distribution angle{ -RE::NI_PI, RE::NI_PI };
+
+		std::vector<BoneID> keyBones;
+		for (int k = 0; k < a_keyBones; ++k) {
+			keyBones.push_back(BoneTable::Intern(std::format("PAR benchmark bone {}", k)));
+		}
+
+		std::vector<FramePtr> frames;
+		for (int i = 0; i < a_frames; ++i) {
+			auto frame = std::make_shared<Frame>();
+			for (const auto bone : keyBones) {
+				RE::NiTransform transform;
+				transform.rotate.SetEulerAnglesXYZ(angle(rng), angle(rng), angle(rng));
+				frame->emplace_back(Override{ bone, transform });
+			}
+			frames.push_back(std::move(frame));
+		}
+
+		PoseIndex index;
+		const auto start = std::chrono::steady_clock::now();
+		index.Build(frames, keyBones);
+		const auto built = std::chrono::steady_clock::now();
+
+		std::vector<float> queries(QUERIES * index.GetStride(), 0.f);
+		for (int q = 0; q < QUERIES; ++q) {
+			for (std::size_t k = 0; k < keyBones.size(); ++k) {
+				RE::NiMatrix3 rotate;
+				rotate.SetEulerAnglesXYZ(angle(rng), angle(rng), angle(rng));
+				PoseIndex::Describe(rotate, queries.data() + q * index.GetStride() + k * PoseIndex::DIMENSIONS_PER_BONE);
+			}
+		}
+
+		std::vector<std::size_t> tree(QUERIES);
+		std::vector<std::size_t> linear(QUERIES);
+
+		const auto treeStart = std::chrono::steady_clock::now();
+		for (int q = 0; q < QUERIES; ++q) {
+			tree[q] = index.Nearest(queries.data() + q * index.GetStride());
+		}
+		const auto linearStart = std::chrono::steady_clock::now();
+		for (int q = 0; q < QUERIES; ++q) {
+			linear[q] = index.NearestLinear(queries.data() + q * index.GetStride());
+		}
+		const auto end = std::chrono::steady_clock::now();
+
+		int differ = 0;
+		for (int q = 0; q < QUERIES; ++q) {
+			differ += tree[q] != linear[q];
+		}
+
+		const auto perQuery = [](auto a_duration) { return std::chrono::duration<float, std::micro>(a_duration).count() / QUERIES; };
+
+		logger::info("pose lookup benchmark: {} frames, {} key bones, built in {:.2f}ms ({} KiB)",
+			a_frames, a_keyBones, std::chrono::duration<float, std::milli>(built - start).count(), index.GetSize() / 1024);
+		logger::info("  kd-tree {:.2f}us, linear scan {:.2f}us per lookup, {} of {} results differ",
+			perQuery(linearStart - treeStart), perQuery(end - linearStart), differ, QUERIES);
+	}).detach();
+}
\ No newline at end of file
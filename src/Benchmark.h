@@ -0,0 +1,42 @@
+#pragma once
+
+namespace PAR
+{
+	// Samples the live pipeline for a fixed number of frames and reports percentiles
+	class Benchmark
+	{
+	public:
+		static bool Start(int a_frames, float a_maxFrameUs, float a_maxEvalUs);
+		static bool IsRunning() { return _running; }
+
+		static void RecordFrame(std::chrono::nanoseconds a_cost);
+		static void RecordEvaluation(std::chrono::nanoseconds a_cost);
+		static void RecordCandidates(std::size_t a_candidates, std::size_t a_evaluated, std::size_t a_total);
+
+		// parses a_file with the json DOM and with ReplacerReader, logs the time and memory of both
+		static void CompareLoaders(const std::string& a_file);
+
+		// nearest-frame lookups on random poses, KD-tree against a linear scan
+		static void ComparePoseLookup(int a_frames, int a_keyBones);
+
+	private:
+		static void Finish();
+
+		static inline std::atomic<bool> _running = false;
+
+		static inline std::vector<float> _frameCosts;
+		static inline std::vector<float> _evalCosts;
+
+		static inline std::size_t _selections = 0;
+		static inline std::size_t _candidates = 0;
+		static inline std::size_t _evaluated = 0;
+		static inline std::size_t _replacers = 0;
+
+		static inline int _target = 0;
+		static inline float _maxFrameUs = 0.f;
+		static inline float _maxEvalUs = 0.f;
+		static inline std::size_t _startMemory = 0;
+
+		static inline std::mutex _mutex;
+	};
+}
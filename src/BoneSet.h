@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Free of game types, shared with tools/SelectionReplay
+
+namespace PAR
+{
+	typedef std::uint16_t BoneID;
+
+	// Bitset over interned bone ids
+	class BoneSet
+	{
+	public:
+		void Insert(BoneID a_id)
+		{
+			const std::size_t word = a_id / 64u;
+			if (_words.size() <= word) {
+				_words.resize(word + 1);
+			}
+			_words[word] |= std::uint64_t{ 1 } << (a_id % 64);
+		}
+
+		void Merge(const BoneSet& a_other)
+		{
+			if (_words.size() < a_other._words.size()) {
+				_words.resize(a_other._words.size());
+			}
+			for (std::size_t i = 0; i < a_other._words.size(); ++i) {
+				_words[i] |= a_other._words[i];
+			}
+		}
+
+		bool Contains(BoneID a_id) const
+		{
+			const std::size_t word = a_id / 64u;
+			return word < _words.size() && (_words[word] & (std::uint64_t{ 1 } << (a_id % 64))) != 0;
+		}
+
+		bool Intersects(const BoneSet& a_other) const
+		{
+			const auto count = std::min(_words.size(), a_other._words.size());
+			for (std::size_t i = 0; i < count; ++i) {
+				if (_words[i] & a_other._words[i])
+					return true;
+			}
+			return false;
+		}
+
+		bool IsSubsetOf(const BoneSet& a_other) const
+		{
+			for (std::size_t i = 0; i < _words.size(); ++i) {
+				const auto other = i < a_other._words.size() ? a_other._words[i] : 0;
+				if (_words[i] & ~other)
+					return false;
+			}
+			return true;
+		}
+
+		bool Empty() const
+		{
+			return std::ranges::all_of(_words, [](auto word) { return word == 0; });
+		}
+
+	private:
+		std::vector<std::uint64_t> _words;
+	};
+}
@@ -0,0 +1,43 @@
+#include "BoneTable.h"
+
+using namespace PAR;
+
+BoneID BoneTable::Intern(std::string_view a_name)
+{
+	std::unique_lock lock{ _mutex };
+
+	auto size = _size.load(std::memory_order_relaxed);
+	if (size == 0) {
+		// reserve id 0 for nodes without a name
+		_chunks[0].store(new Entry[CHUNK_SIZE], std::memory_order_release);
+		_ids[""] = INVALID_BONE;
+		size = 1;
+		_size.store(size, std::memory_order_release);
+	}
+
+	std::string name{ a_name };
+	if (const auto iter = _ids.find(name); iter != _ids.end()) {
+		return iter->second;
+	}
+
+	if (size >= CHUNK_SIZE * MAX_CHUNKS) {
+		logger::error("bone table is full, ignoring node {}", name);
+		return INVALID_BONE;
+	}
+
+	const auto chunk = size / CHUNK_SIZE;
+	if (size % CHUNK_SIZE == 0) {
+		// chunks are never freed, ids stay valid until the process exits
+		_chunks[chunk].store(new Entry[CHUNK_SIZE], std::memory_order_release);
+	}
+
+	auto& entry = _chunks[chunk].load(std::memory_order_relaxed)[size % CHUNK_SIZE];
+	entry.name = name;
+	entry.fixedName = name;
+
+	const auto id = static_cast<BoneID>(size);
+	_ids.emplace(std::move(name), id);
+	_size.store(size + 1, std::memory_order_release);
+
+	return id;
+}
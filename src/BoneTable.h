@@ -0,0 +1,40 @@
+#pragma once
+
+#include "BoneSet.h"
+
+namespace PAR
+{
+	// Global interning table for node names, ids are stable for the lifetime of the process
+	class BoneTable
+	{
+	public:
+		static constexpr BoneID INVALID_BONE = 0;
+		static constexpr std::size_t CHUNK_SIZE = 256;
+		static constexpr std::size_t MAX_CHUNKS = 256;
+
+		static BoneID Intern(std::string_view a_name);
+
+		static const std::string& GetName(BoneID a_id) { return GetEntry(a_id).name; }
+		static const RE::BSFixedString& GetFixedName(BoneID a_id) { return GetEntry(a_id).fixedName; }
+		static std::size_t Size() { return _size.load(std::memory_order_acquire); }
+
+	private:
+		struct Entry
+		{
+			std::string name;
+			RE::BSFixedString fixedName;
+		};
+
+		// chunks never move once published, so readers don't need to lock
+		static const Entry& GetEntry(BoneID a_id)
+		{
+			return _chunks[a_id / CHUNK_SIZE].load(std::memory_order_acquire)[a_id % CHUNK_SIZE];
+		}
+
+		static inline std::array<std::atomic<Entry*>, MAX_CHUNKS> _chunks{};
+		static inline std::atomic<std::size_t> _size = 0;
+
+		static inline std::unordered_map<std::string, BoneID> _ids;
+		static inline std::mutex _mutex;
+	};
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+// Pre-parsed replacer files of one directory, written by tools/Validator and read by ReplacerReader, msgpack
+//
+// { version: u32, files: [ { file: name in the directory, size: u64, mtime: i64, hash: u64, data: bin or nil } ] }
+//
+// data is the file's json re-encoded as msgpack, nil if it didn't parse. The bundle is only a cache:
+// it is ignored unless it lists every .json file of its directory with the same size and hash.
+// mtime is the file's last write time in ticks of std::filesystem's clock, a file with the same size and
+// mtime is taken as unchanged without reading it, only a mismatch falls back to hashing its bytes
+
+namespace PAR::Bundle
+{
+	constexpr std::string_view NAME = "replacers.parpack";
+	constexpr std::uint32_t VERSION = 3;
+
+	// FNV-1a, the same on every platform the bundle may be built on
+	inline std::uint64_t Hash(const std::uint8_t* a_data, std::size_t a_size)
+	{
+		std::uint64_t hash = 0xCBF29CE484222325;
+		for (std::size_t i = 0; i < a_size; ++i) {
+			hash = (hash ^ a_data[i]) * 0x100000001B3;
+		}
+		return hash;
+	}
+
+	// the clock's epoch differs between standard libraries, a bundle built elsewhere only costs the hashing
+	inline std::int64_t WriteTime(const std::filesystem::path& a_path)
+	{
+		return static_cast<std::int64_t>(std::filesystem::last_write_time(a_path).time_since_epoch().count());
+	}
+}
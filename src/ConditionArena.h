@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace PAR
+{
+	// Condition items of one replacer in a single allocation, released together with the condition
+	// Free of game types, Condition only needs a head pointer to a chain of Items linked through next
+	template <class Condition, class Item>
+	class ConditionArena
+	{
+	public:
+		// Parses every non-empty text into the chain with a_parse(text, item), nullptr if any of them fails or there are none
+		// The condition shares ownership with the arena, the items go away with the last reference to it
+		template <class Texts, class Parse>
+		static std::shared_ptr<Condition> Build(const Texts& a_texts, Parse&& a_parse)
+		{
+			auto arena = std::make_shared<ConditionArena>();
+
+			std::size_t count = 0;
+			for (const auto& text : a_texts) {
+				count += text.empty() ? 0 : 1;
+			}
+			arena->_items.reserve(count);
+
+			auto head = std::addressof(arena->_condition.head);
+			for (const auto& text : a_texts) {
+				if (text.empty())
+					continue;
+
+				// never reallocates, the chain points into the reserved storage
+				auto& item = arena->_items.emplace_back();
+				if (!a_parse(text, item))
+					return nullptr;
+
+				*head = std::addressof(item);
+				head = std::addressof(item.next);
+			}
+
+			if (arena->_items.empty())
+				return nullptr;
+
+			return std::shared_ptr<Condition>(arena, std::addressof(arena->_condition));
+		}
+
+		ConditionArena() = default;
+		ConditionArena(const ConditionArena&) = delete;
+		ConditionArena& operator=(const ConditionArena&) = delete;
+
+		~ConditionArena()
+		{
+			// the items belong to the arena, keep the condition from freeing the chain itself
+			_condition.head = nullptr;
+		}
+
+	private:
+		Condition _condition;
+		std::vector<Item> _items;
+	};
+}
@@ -5,99 +5,64 @@
 
 using namespace PAR;
 
-auto ConditionParser::Parse(std::string_view a_text, const RefMap& a_refs) -> RE::TESConditionItem*
+// Fills a_item in place, the caller owns its storage
+bool ConditionParser::Parse(std::string_view a_text, const RefMap& a_refs, RE::TESConditionItem& a_item)
 {
-	const auto splits = Util::Split(std::string{ a_text }, "<>"sv) | std::ranges::views::transform([](std::string& a_str) { return Util::trim(a_str); }) | std::ranges::to<std::vector>();
-
-	const std::string text{ splits.size() == 2 ? splits[1] : splits[0] };
-	const std::string refStr{ splits.size() == 2 ? splits[0] : "" };
-
-	static srell::regex re{
-		R"((\w+)\s+((\w+)(\s+(\w+))?\s*)?(==|!=|>|>=|<|<=)\s*(\w+)(\s+(AND|OR))?)"
-	};
-
-	srell::cmatch m;
-	if (!srell::regex_match(text.data(), m, re)) {
+	ConditionSyntax::Condition condition;
+	if (!ConditionSyntax::Parse(a_text, condition)) {
 		logger::error("Could not parse condition: {}"sv, a_text);
-		return nullptr;
+		return false;
 	}
 
 	RE::CONDITION_ITEM_DATA data;
-	auto& mFunction = m[1];
-	auto& mParam1 = m[3];
-	auto& mParam2 = m[5];
-	auto& mOperator = m[6];
-	auto& mComparand = m[7];
-	auto& mConnective = m[9];
 
-	auto function = RE::SCRIPT_FUNCTION::LocateScriptCommand(mFunction.str().data());
+	auto function = RE::SCRIPT_FUNCTION::LocateScriptCommand(condition.function.data());
 
 	if (!function || !function->conditionFunction) {
-		logger::error("Did not find condition function: {}"sv, mFunction.str());
-		return nullptr;
+		logger::error("Did not find condition function: {}"sv, condition.function);
+		return false;
 	}
 
 	auto functionIndex = Util::to_underlying(function->output) - 0x1000;
 	data.functionData.function = static_cast<RE::FUNCTION_DATA::FunctionID>(functionIndex);
 
-	if (mParam1.matched) {
-		if (function->numParams >= 1) {
-			data.functionData.params[0] = std::bit_cast<void*>(
-				ParseParam(mParam1.str(), function->params[0].paramType.get(), a_refs));
-		} else {
-			logger::warn("Condition function {} ignoring parameter: {}", function->functionName, mParam1.str());
-		}
-	}
-
-	if (mParam2.matched) {
-		if (function->numParams >= 2) {
-			data.functionData.params[1] = std::bit_cast<void*>(
-				ParseParam(mParam2.str(), function->params[1].paramType.get(), a_refs));
+	for (std::size_t i = 0; i < condition.numParams; ++i) {
+		const auto& param = condition.params[i];
+		if (function->numParams > i) {
+			data.functionData.params[i] = std::bit_cast<void*>(
+				ParseParam(param, function->params[i].paramType.get(), a_refs));
 		} else {
-			logger::warn("Condition function {} ignoring parameter: {}", function->functionName, mParam2.str());
+			logger::warn("Condition function {} ignoring parameter: {}", function->functionName, param);
 		}
 	}
 
-	if (mOperator.matched) {
-		auto op = mOperator.str();
-		if (op == "=="s) {
-			data.flags.opCode = RE::CONDITION_ITEM_DATA::OpCode::kEqualTo;
-		} else if (op == "!="s) {
-			data.flags.opCode = RE::CONDITION_ITEM_DATA::OpCode::kNotEqualTo;
-		} else if (op == ">"s) {
-			data.flags.opCode = RE::CONDITION_ITEM_DATA::OpCode::kGreaterThan;
-		} else if (op == ">="s) {
-			data.flags.opCode = RE::CONDITION_ITEM_DATA::OpCode::kGreaterThanOrEqualTo;
-		} else if (op == "<"s) {
-			data.flags.opCode = RE::CONDITION_ITEM_DATA::OpCode::kLessThan;
-		} else if (op == "<="s) {
-			data.flags.opCode = RE::CONDITION_ITEM_DATA::OpCode::kLessThanOrEqualTo;
-		}
-	} else {
+	const auto& op = condition.op;
+	if (op == "=="s) {
+		data.flags.opCode = RE::CONDITION_ITEM_DATA::OpCode::kEqualTo;
+	} else if (op == "!="s) {
 		data.flags.opCode = RE::CONDITION_ITEM_DATA::OpCode::kNotEqualTo;
+	} else if (op == ">"s) {
+		data.flags.opCode = RE::CONDITION_ITEM_DATA::OpCode::kGreaterThan;
+	} else if (op == ">="s) {
+		data.flags.opCode = RE::CONDITION_ITEM_DATA::OpCode::kGreaterThanOrEqualTo;
+	} else if (op == "<"s) {
+		data.flags.opCode = RE::CONDITION_ITEM_DATA::OpCode::kLessThan;
+	} else if (op == "<="s) {
+		data.flags.opCode = RE::CONDITION_ITEM_DATA::OpCode::kLessThanOrEqualTo;
 	}
 
-	if (mComparand.matched) {
-		auto comparand = mComparand.str();
-		if (auto global = RE::TESForm::LookupByEditorID<RE::TESGlobal>(comparand)) {
-			data.comparisonValue.g = global;
-			data.flags.global = true;
-		} else {
-			data.comparisonValue.f = std::stof(comparand);
-		}
+	const auto& comparand = condition.comparand;
+	if (auto global = RE::TESForm::LookupByEditorID<RE::TESGlobal>(comparand)) {
+		data.comparisonValue.g = global;
+		data.flags.global = true;
 	} else {
-		data.comparisonValue.f = 0.f;
+		data.comparisonValue.f = std::stof(comparand);
 	}
 
-	if (mConnective.matched) {
-		auto connective = mConnective.str();
-		if (connective == "OR"s) {
-			data.flags.isOR = true;
-		}
-	}
+	data.flags.isOR = condition.isOR;
 
-	if (!refStr.empty()) {
-		if (const auto ref = LookupForm<RE::TESObjectREFR>(refStr, a_refs)) {
+	if (!condition.ref.empty()) {
+		if (const auto ref = LookupForm<RE::TESObjectREFR>(condition.ref, a_refs)) {
 			data.runOnRef = ref->CreateRefHandle();
 			data.object = RE::CONDITIONITEMOBJECT::kRef;
 		} else {
@@ -105,9 +70,8 @@ auto ConditionParser::Parse(std::string_view a_text, const RefMap& a_refs) -> RE
 		}
 	}
 
-	auto conditionItem = new RE::TESConditionItem();
-	conditionItem->data = data;
-	return conditionItem;
+	a_item.data = data;
+	return true;
 }
 
 auto ConditionParser::ParseParam(
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ConditionSyntax.h"
 #include "Util.h"
 
 // stolen from DAV (https://github.com/Exit-9B/DynamicArmorVariants)
@@ -13,7 +14,7 @@ namespace PAR
 
 		ConditionParser() = delete;
 
-		static auto Parse(std::string_view a_text, const RefMap& a_refs) -> RE::TESConditionItem*;
+		static bool Parse(std::string_view a_text, const RefMap& a_refs, RE::TESConditionItem& a_item);
 
 	private:
 		union ConditionParam
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Grammar of a condition string, free of game types so tools/Validator checks files with
+// the same rules ConditionParser resolves them with
+//
+//   [ref <>] Function [param1 [param2]] op comparand [AND|OR]
+//
+// words are [A-Za-z0-9_]+, op is one of == != > >= < <=
+
+namespace PAR::ConditionSyntax
+{
+	struct Condition
+	{
+		std::string ref;
+		std::string function;
+		std::array<std::string, 2> params;
+		std::size_t numParams = 0;
+		std::string op;
+		std::string comparand;
+		bool isOR = false;
+	};
+
+	namespace detail
+	{
+		inline bool IsWordChar(char a_char)
+		{
+			return (a_char >= 'a' && a_char <= 'z') || (a_char >= 'A' && a_char <= 'Z') || (a_char >= '0' && a_char <= '9') || a_char == '_';
+		}
+
+		inline bool IsSpace(char a_char)
+		{
+			return a_char == ' ' || a_char == '\t' || a_char == '\n' || a_char == '\r' || a_char == '\f' || a_char == '\v';
+		}
+
+		inline std::string_view Trim(std::string_view a_text)
+		{
+			while (!a_text.empty() && IsSpace(a_text.front())) {
+				a_text.remove_prefix(1);
+			}
+			while (!a_text.empty() && IsSpace(a_text.back())) {
+				a_text.remove_suffix(1);
+			}
+			return a_text;
+		}
+
+		class Cursor
+		{
+		public:
+			explicit Cursor(std::string_view a_text) :
+				_text(a_text)
+			{}
+
+			bool AtEnd() const { return _pos == _text.size(); }
+			bool AtWord() const { return !AtEnd() && IsWordChar(_text[_pos]); }
+
+			std::size_t SkipSpace()
+			{
+				const auto start = _pos;
+				while (!AtEnd() && IsSpace(_text[_pos])) {
+					++_pos;
+				}
+				return _pos - start;
+			}
+
+			std::string Word()
+			{
+				const auto start = _pos;
+				while (AtWord()) {
+					++_pos;
+				}
+				return std::string{ _text.substr(start, _pos - start) };
+			}
+
+			std::string Operator()
+			{
+				for (const std::string_view op : { "==", "!=", ">=", "<=", ">", "<" }) {
+					if (_text.substr(_pos).starts_with(op)) {
+						_pos += op.size();
+						return std::string{ op };
+					}
+				}
+				return {};
+			}
+
+		private:
+			std::string_view _text;
+			std::size_t _pos = 0;
+		};
+	}
+
+	// false if a_text doesn't follow the grammar, a_condition is then left partially filled
+	inline bool Parse(std::string_view a_text, Condition& a_condition)
+	{
+		using namespace detail;
+
+		// "ref <> condition", any further "<>" is ignored like the text behind it
+		auto text = a_text;
+		if (const auto split = a_text.find("<>"); split != std::string_view::npos) {
+			const auto rest = a_text.substr(split + 2);
+			if (rest.find("<>") == std::string_view::npos) {
+				a_condition.ref = std::string{ Trim(a_text.substr(0, split)) };
+				text = rest;
+			} else {
+				text = a_text.substr(0, split);
+			}
+		}
+
+		Cursor cursor{ Trim(text) };
+
+		a_condition.function = cursor.Word();
+		if (a_condition.function.empty() || !cursor.SkipSpace())
+			return false;
+
+		if (cursor.AtWord()) {
+			a_condition.params[a_condition.numParams++] = cursor.Word();
+			if (cursor.SkipSpace() && cursor.AtWord()) {
+				a_condition.params[a_condition.numParams++] = cursor.Word();
+				cursor.SkipSpace();
+			}
+		}
+
+		a_condition.op = cursor.Operator();
+		if (a_condition.op.empty())
+			return false;
+
+		cursor.SkipSpace();
+		a_condition.comparand = cursor.Word();
+		if (a_condition.comparand.empty())
+			return false;
+
+		if (cursor.AtEnd())
+			return true;
+
+		if (!cursor.SkipSpace())
+			return false;
+
+		const auto connective = cursor.Word();
+		if (connective != "AND" && connective != "OR")
+			return false;
+
+		a_condition.isOR = connective == "OR";
+		return cursor.AtEnd();
+	}
+}
@@ -0,0 +1,139 @@
+#include "DumpJob.h"
+
+using namespace PAR;
+
+DumpJob::DumpJob(const std::vector<RE::Actor*>& a_actors, std::string a_dir, const std::vector<std::string>& a_names, const std::vector<std::string>& a_nodes, int a_target, bool a_rotate, bool a_translate, bool a_scale) :
+	_dir(a_dir), _rotate(a_rotate), _translate(a_translate), _scale(a_scale), _target(a_target)
+{
+	for (const auto& node : a_nodes) {
+		_bones.push_back(BoneTable::Intern(node));
+	}
+
+	for (std::size_t i = 0; i < a_actors.size(); ++i) {
+		_subjects.push_back(Subject{ a_actors[i], a_names[i], "Data\\SKSE\\PartialAnimationReplacer\\Replacers\\" + _dir + "\\" + a_names[i] });
+	}
+}
+
+bool DumpJob::Record()
+{
+	if (IsDone())
+		return true;
+
+	// frames stay aligned across actors, skip the frame if any of them can't be recorded
+	for (auto& subject : _subjects) {
+		if (!Resolve(subject))
+			return false;
+	}
+
+	if (_stride == 0)
+		return false;
+
+	if (_buffer.empty()) {
+		_buffer.reserve(_stride * static_cast<std::size_t>(_target));
+	}
+
+	for (const auto& subject : _subjects) {
+		for (std::size_t i = 0; i < subject.nodes.size(); ++i) {
+			_buffer.emplace_back(Override{ subject.bones[i], subject.nodes[i]->local });
+		}
+	}
+
+	_recorded += 1;
+
+	return IsDone();
+}
+
+bool DumpJob::SharesFiles(const DumpJob& a_other) const
+{
+	return std::ranges::any_of(_subjects, [&a_other](const Subject& a_subject) {
+		return std::ranges::any_of(a_other._subjects, [&a_subject](const Subject& a_theirs) {
+			// paths on Windows are case insensitive
+			return _stricmp(a_theirs.file.c_str(), a_subject.file.c_str()) == 0;
+		});
+	});
+}
+
+// Looks nodes up by name only when the actor's 3D changed since the last frame
+bool DumpJob::Resolve(Subject& a_subject)
+{
+	const auto obj = a_subject.actor->Get3D(false);
+	if (!obj)
+		return false;
+
+	if (a_subject.root.get() == obj)
+		return true;
+
+	a_subject.root.reset();
+	a_subject.nodes.clear();
+
+	if (!a_subject.resolved) {
+		// the first resolution fixes which bones this actor contributes to every frame
+		for (const auto bone : _bones) {
+			if (const auto node = obj->GetObjectByName(BoneTable::GetFixedName(bone))) {
+				a_subject.bones.push_back(bone);
+				a_subject.nodes.push_back(node);
+			}
+		}
+
+		a_subject.offset = _stride;
+		a_subject.resolved = true;
+		_stride += a_subject.bones.size();
+	} else {
+		for (const auto bone : a_subject.bones) {
+			const auto node = obj->GetObjectByName(BoneTable::GetFixedName(bone));
+			if (!node) {
+				a_subject.nodes.clear();
+				return false;
+			}
+			a_subject.nodes.push_back(node);
+		}
+	}
+
+	a_subject.root.reset(obj);
+	return true;
+}
+
+std::vector<DumpOutput> DumpJob::Finish() const
+{
+	std::vector<DumpOutput> outputs;
+
+	for (const auto& subject : _subjects) {
+		if (subject.bones.empty())
+			continue;
+
+		auto& output = outputs.emplace_back(DumpOutput{ subject.file, {}, _rotate, _translate, _scale });
+		output.frames.reserve(static_cast<std::size_t>(_recorded));
+		for (std::size_t frame = 0; frame < static_cast<std::size_t>(_recorded); ++frame) {
+			const auto begin = _buffer.begin() + static_cast<std::ptrdiff_t>(frame * _stride + subject.offset);
+			output.frames.emplace_back(begin, begin + static_cast<std::ptrdiff_t>(subject.bones.size()));
+		}
+	}
+
+	return outputs;
+}
+
+void DumpOutput::Write() const
+{
+	TRACE_SCOPE("DumpOutput::Write");
+
+	ReplacerData data;
+
+	const fs::directory_entry entry{ file };
+	if (entry.exists()) {
+		try {
+			std::ifstream f{ file };
+			const auto existingData = json::parse(f);
+			data = existingData.get<ReplacerData>();
+		} catch (...) {}
+	}
+
+	data.frames = frames;
+	data.rotate = rotate;
+	data.translate = translate;
+	data.scale = scale;
+
+	json j = data;
+
+	std::ofstream f(file);
+	f << std::setfill(' ') << std::setw(2) << j;
+}
@@ -1,69 +1,65 @@
 #pragma once
 
 #include "Replacer.h"
+#include "Tracer.h"
 
 namespace PAR
 {
+	// Recorded frames of one actor, written to its replacer file off the main thread
+	struct DumpOutput
+	{
+		std::string file;
+		std::vector<Frame> frames;
+
+		bool rotate;
+		bool translate;
+		bool scale;
+
+		void Write() const;
+	};
+
+	// Records the same node list on several actors in lockstep, one replacer file per actor
 	class DumpJob
 	{
 	public:
-		DumpJob(RE::Actor* a_actor, std::string a_dir, std::string a_name, std::vector<std::string> a_nodes, int a_target, bool a_rotate, bool a_translate, bool a_scale) :
-			_actor(a_actor), _dir(a_dir), _name(a_name), _nodes(a_nodes), _target(a_target), _rotate(a_rotate), _translate(a_translate), _scale(a_scale) {}
-		inline bool IsDone() const { return _frames.size() >= _target; }
-		inline bool Record()
-		{
-			if (IsDone())
-				return true;
-			
-			if (const auto obj = _actor->Get3D(false)) {
-				Frame frame;
-
-				for (const auto& nodeName : _nodes) {
-					if (const auto node = obj->GetObjectByName(nodeName)) {
-						frame.emplace_back(Override{ nodeName, node->local });
-					}
-				}
-
-				if (!frame.empty())
-					_frames.emplace_back(frame);
-			}
-
-			return IsDone();
-		}
-
-		inline void Complete() const { 
-			ReplacerData data;
-
-			const std::string fileName{ "Data\\SKSE\\PartialAnimationReplacer\\Replacers\\" + _dir + "\\" + _name };
-			const fs::directory_entry entry{ fileName };
-			if (entry.exists()) {
-				try {
-					std::ifstream f{ fileName };
-					json d;
-					const auto existingData = json::parse(f);
-					data = existingData.get<ReplacerData>();
-				} catch (...) {}
-			}
-
-			data.frames = _frames;
-			data.rotate = _rotate;
-			data.translate = _translate;
-			data.scale = _scale;
-
-			json j = data;
-
-			std::string s = j.dump(2);
-			std::ofstream file(fileName);
-			file << std::setfill(' ') << std::setw(2) << j;
-		}
+		DumpJob(const std::vector<RE::Actor*>& a_actors, std::string a_dir, const std::vector<std::string>& a_names, const std::vector<std::string>& a_nodes, int a_target, bool a_rotate, bool a_translate, bool a_scale);
+
+		inline bool IsDone() const { return _recorded >= _target; }
+		bool Record();
+
+		// main thread, only slices the recorded frames, the file I/O is left to DumpOutput::Write
+		std::vector<DumpOutput> Finish() const;
+
+		bool SharesFiles(const DumpJob& a_other) const;
 	private:
-		RE::Actor* _actor;
-		
+		struct Subject
+		{
+			RE::Actor* actor;
+			std::string name;
+			std::string file;
+
+			// the 3D the nodes were resolved against, keeps them alive
+			RE::NiPointer<RE::NiAVObject> root;
+			bool resolved = false;
+
+			std::vector<BoneID> bones;
+			std::vector<RE::NiAVObject*> nodes;
+
+			// position of this actor's overrides within a recorded frame
+			std::size_t offset = 0;
+		};
+
+		bool Resolve(Subject& a_subject);
+
+		std::vector<Subject> _subjects;
+		std::vector<BoneID> _bones;
+
 		std::string _dir;
-		std::string _name;
 
-		std::vector<std::string> _nodes;
-		std::vector<Frame> _frames;
+		// _recorded frames of _stride overrides, the actors in order
+		std::vector<Override> _buffer;
+		std::size_t _stride = 0;
+		int _recorded = 0;
 
 		bool _rotate;
 		bool _translate;
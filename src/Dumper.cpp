@@ -1,16 +1,25 @@
 #include "Dumper.h"
+#include "Profiler.h"
 
 using namespace PAR;
 
-bool Dumper::QueueDump(RE::Actor* a_actor, std::string a_dir, std::string a_name, std::string a_nodes, int a_target, bool a_rotate, bool a_translate, bool a_scale)
+// Prepares the job on the calling thread, nothing here is shared with OnFrame but the queue
+bool Dumper::QueueDump(const std::vector<RE::Actor*>& a_actors, std::string a_dir, const std::vector<std::string>& a_names, std::string a_nodes, int a_target, bool a_rotate, bool a_translate, bool a_scale)
 {
-	std::unique_lock lock{ _mutex };
+	if (a_actors.empty() || a_actors.size() != a_names.size() || std::ranges::count(a_actors, nullptr))
+		return false;
 
-	std::string id{ a_dir + "\\" + a_name };
+	// sorted so that the same set of files always maps to the same job
+	auto names = a_names;
+	std::ranges::sort(names);
+	if (std::ranges::adjacent_find(names) != names.end()) {
+		logger::error("dump into {} names the same file twice", a_dir);
+		return false;
+	}
 
-	const auto iter = _jobs.find(id);
-	if (iter != _jobs.end()) {
-		iter->second.Complete();
+	std::string id{ a_dir + "\\" + names[0] };
+	for (std::size_t i = 1; i < names.size(); ++i) {
+		id += "," + names[i];
 	}
 
 	const std::string fileName{ std::format("Data\\SKSE\\PartialAnimationReplacer\\Replacers\\{}\\Config\\{}", a_dir, a_nodes) };
@@ -25,28 +34,77 @@ bool Dumper::QueueDump(RE::Actor* a_actor, std::string a_dir, std::string a_name
 	if (nodes.empty())
 		return false;
 	
-	_jobs.insert({ id, DumpJob{ a_actor, a_dir, a_name, nodes, a_target, a_rotate, a_translate, a_scale } });
+	_pending.Push({ std::move(id), DumpJob{ a_actors, a_dir, a_names, nodes, a_target, a_rotate, a_translate, a_scale } });
 
 	return true;
 }
 
-void Dumper::OnFrame()
+void Dumper::Drain()
+{
+	while (auto pending = _pending.Pop()) {
+		auto& [id, job] = *pending;
+
+		// a job writing exactly the same files replaces the running one, a partial overlap would race on the shared files
+		if (const auto iter = _jobs.find(id); iter != _jobs.end()) {
+			Write(iter->second.Finish());
+			_jobs.erase(iter);
+		} else if (const auto other = std::ranges::find_if(_jobs, [&job](const auto& a_entry) { return a_entry.second.SharesFiles(job); }); other != _jobs.end()) {
+			logger::error("rejecting dump {}, it writes files of the running dump {}", id, other->first);
+			continue;
+		}
+
+		_jobs.emplace(std::move(id), std::move(job));
+	}
+}
+
+// The writer exits once nothing is left to write, no thread outlives the dumps, the next completed job starts another
+void Dumper::Write(std::vector<DumpOutput>&& a_outputs)
 {
-	if (_mutex.try_lock()) {
-		std::vector<std::string> clear;
-
-		for (auto& [id, job] : _jobs) {
-			if (job.Record()) {
-				logger::info("completing job {}", id);
-				job.Complete();
-				clear.push_back(id);
-			}
+	std::unique_lock lock{ _writeLock };
+	std::ranges::move(a_outputs, std::back_inserter(_writes));
+
+	if (_writerRunning || _writes.empty())
+		return;
+
+	_writerRunning = true;
+	std::thread([]() {
+		Tracer::SetThreadName("dump writer");
+
+		std::unique_lock lock{ _writeLock };
+		while (!_writes.empty()) {
+			auto output = std::move(_writes.front());
+			_writes.pop_front();
+			lock.unlock();
+
+			output.Write();
+			logger::info("wrote {}", output.file);
+
+			lock.lock();
 		}
 
-		for (const auto& id : clear) {
-			_jobs.erase(id);
+		// under the lock, a Write that sees the flag still set has its outputs taken by the loop above
+		_writerRunning = false;
+	}).detach();
+}
+
+void Dumper::OnFrame()
+{
+	Profiler::ScopedPhase phase{ Phase::kDumperOnFrame };
+
+	// a job queued before this frame records it
+	Drain();
+
+	std::vector<std::string> clear;
+
+	for (auto& [id, job] : _jobs) {
+		if (job.Record()) {
+			logger::info("completing job {}", id);
+			Write(job.Finish());
+			clear.push_back(id);
 		}
+	}
 
-		_mutex.unlock();
+	for (const auto& id : clear) {
+		_jobs.erase(id);
 	}
 }
\ No newline at end of file
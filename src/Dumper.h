@@ -1,16 +1,28 @@
 #pragma once
 
 #include "DumpJob.h"
+#include "MPSCQueue.h"
 
 namespace PAR
 {
 	class Dumper
 	{
 	public:
-		static bool QueueDump(RE::Actor* a_actor, std::string a_dir, std::string a_name, std::string a_nodes, int a_target, bool a_rotate, bool a_translate, bool a_scale);
+		static bool QueueDump(const std::vector<RE::Actor*>& a_actors, std::string a_dir, const std::vector<std::string>& a_names, std::string a_nodes, int a_target, bool a_rotate, bool a_translate, bool a_scale);
 		static void OnFrame();
 	private:
+		static void Drain();
+		static void Write(std::vector<DumpOutput>&& a_outputs);
+
+		// completed jobs are written by one worker in completion order, a replaced job never overwrites its successor
+		static inline std::mutex _writeLock;
+		static inline std::deque<DumpOutput> _writes;
+		static inline bool _writerRunning = false;
+
+		// only touched by OnFrame
 		static inline std::unordered_map<std::string, DumpJob> _jobs;
-		static inline std::mutex _mutex;
+
+		// jobs prepared by QueueDump, handed over to the next OnFrame
+		static inline MPSCQueue<std::pair<std::string, DumpJob>> _pending;
 	};
 }
\ No newline at end of file
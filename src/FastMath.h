@@ -0,0 +1,172 @@
+#pragma once
+
+#include <emmintrin.h>
+
+// Bounded-error polynomial approximations evaluated on 4 lanes at once, free of game types so
+// tools/Tests checks them against libm
+// Max errors as measured there: sincos ~1e-6 within a few turns, asin and atan2 ~3e-7 rad
+
+namespace PAR::FastMath
+{
+	inline constexpr float PI = 3.14159265358979323846f;
+	inline constexpr float HALF_PI = PI / 2.f;
+	inline constexpr float TWO_PI = PI * 2.f;
+
+	inline __m128 Select(__m128 a_false, __m128 a_true, __m128 a_mask)
+	{
+		return _mm_or_ps(_mm_and_ps(a_mask, a_true), _mm_andnot_ps(a_mask, a_false));
+	}
+
+	inline __m128 Abs(__m128 a_x)
+	{
+		return _mm_andnot_ps(_mm_set1_ps(-0.f), a_x);
+	}
+
+	inline __m128 Round(__m128 a_x)
+	{
+		// |x| stays far below 2^23 for any angle this is used with
+		return _mm_cvtepi32_ps(_mm_cvtps_epi32(a_x));
+	}
+
+	inline void SinCos(__m128 a_x, __m128& a_sin, __m128& a_cos)
+	{
+		const auto pi = _mm_set1_ps(PI);
+		const auto halfPi = _mm_set1_ps(HALF_PI);
+
+		// reduce to [-pi, pi]
+		const auto quotient = Round(_mm_mul_ps(a_x, _mm_set1_ps(1.f / TWO_PI)));
+		auto y = _mm_sub_ps(a_x, _mm_mul_ps(quotient, _mm_set1_ps(TWO_PI)));
+
+		// reflect to [-pi/2, pi/2], which flips the sign of the cosine
+		const auto above = _mm_cmpgt_ps(y, halfPi);
+		const auto below = _mm_cmplt_ps(y, _mm_sub_ps(_mm_setzero_ps(), halfPi));
+		y = Select(y, _mm_sub_ps(pi, y), above);
+		y = Select(y, _mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), pi), y), below);
+		const auto sign = Select(_mm_set1_ps(1.f), _mm_set1_ps(-1.f), _mm_or_ps(above, below));
+
+		const auto y2 = _mm_mul_ps(y, y);
+
+		// 11-degree minimax of DirectXMath
+		auto s = _mm_set1_ps(-2.3889859e-08f);
+		s = _mm_add_ps(_mm_mul_ps(s, y2), _mm_set1_ps(2.7525562e-06f));
+		s = _mm_add_ps(_mm_mul_ps(s, y2), _mm_set1_ps(-0.00019840874f));
+		s = _mm_add_ps(_mm_mul_ps(s, y2), _mm_set1_ps(0.0083333310f));
+		s = _mm_add_ps(_mm_mul_ps(s, y2), _mm_set1_ps(-0.16666667f));
+		s = _mm_add_ps(_mm_mul_ps(s, y2), _mm_set1_ps(1.f));
+		a_sin = _mm_mul_ps(s, y);
+
+		// 10-degree minimax
+		auto c = _mm_set1_ps(-2.6051615e-07f);
+		c = _mm_add_ps(_mm_mul_ps(c, y2), _mm_set1_ps(2.4760495e-05f));
+		c = _mm_add_ps(_mm_mul_ps(c, y2), _mm_set1_ps(-0.0013888378f));
+		c = _mm_add_ps(_mm_mul_ps(c, y2), _mm_set1_ps(0.041666638f));
+		c = _mm_add_ps(_mm_mul_ps(c, y2), _mm_set1_ps(-0.5f));
+		c = _mm_add_ps(_mm_mul_ps(c, y2), _mm_set1_ps(1.f));
+		a_cos = _mm_mul_ps(c, sign);
+	}
+
+	// input is clamped to [-1, 1]
+	inline __m128 ASin(__m128 a_x)
+	{
+		const auto x = _mm_min_ps(Abs(a_x), _mm_set1_ps(1.f));
+		const auto root = _mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.f), x));
+
+		// 7-degree minimax of acos(|x|) / sqrt(1 - |x|) of DirectXMath
+		auto r = _mm_set1_ps(-0.0012624911f);
+		r = _mm_add_ps(_mm_mul_ps(r, x), _mm_set1_ps(0.0066700901f));
+		r = _mm_add_ps(_mm_mul_ps(r, x), _mm_set1_ps(-0.0170881256f));
+		r = _mm_add_ps(_mm_mul_ps(r, x), _mm_set1_ps(0.0308918810f));
+		r = _mm_add_ps(_mm_mul_ps(r, x), _mm_set1_ps(-0.0501743046f));
+		r = _mm_add_ps(_mm_mul_ps(r, x), _mm_set1_ps(0.0889789874f));
+		r = _mm_add_ps(_mm_mul_ps(r, x), _mm_set1_ps(-0.2145988016f));
+		r = _mm_add_ps(_mm_mul_ps(r, x), _mm_set1_ps(1.5707963050f));
+
+		const auto result = _mm_sub_ps(_mm_set1_ps(HALF_PI), _mm_mul_ps(r, root));
+
+		// restore the sign of the input
+		return _mm_or_ps(result, _mm_and_ps(a_x, _mm_set1_ps(-0.f)));
+	}
+
+	inline __m128 ATan2(__m128 a_y, __m128 a_x)
+	{
+		const auto ax = Abs(a_x);
+		const auto ay = Abs(a_y);
+
+		const auto hi = _mm_max_ps(ax, ay);
+		const auto lo = _mm_min_ps(ax, ay);
+		const auto zero = _mm_cmpeq_ps(hi, _mm_setzero_ps());
+
+		// atan on [0, 1], 17-degree polynomial of Abramowitz and Stegun 4.4.49
+		const auto a = _mm_div_ps(lo, Select(hi, _mm_set1_ps(1.f), zero));
+		const auto s = _mm_mul_ps(a, a);
+		auto r = _mm_set1_ps(0.0028662257f);
+		r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(-0.0161657367f));
+		r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(0.0429096138f));
+		r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(-0.0752896400f));
+		r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(0.1065626393f));
+		r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(-0.1420889944f));
+		r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(0.1999355085f));
+		r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(-0.3333314528f));
+		r = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(r, s), a), a);
+
+		// expand to the full circle
+		r = Select(r, _mm_sub_ps(_mm_set1_ps(HALF_PI), r), _mm_cmpgt_ps(ay, ax));
+		r = Select(r, _mm_sub_ps(_mm_set1_ps(PI), r), _mm_cmplt_ps(a_x, _mm_setzero_ps()));
+		r = Select(r, _mm_sub_ps(_mm_setzero_ps(), r), _mm_cmplt_ps(a_y, _mm_setzero_ps()));
+
+		return r;
+	}
+
+	// Extrinsic YXZ (Y applied first) Tait-Bryan angles of a rotation, or equivalently intrinsic ZXY
+	// Within 0.26 degrees of x = +-90 degrees only x and z are recovered, y is 0
+	// One bone per call like the limits are applied: the lanes hold its axes, the fourth is idle and asin runs on one
+	inline void MatToEulerYXZ(const float (&a_rot)[3][3], float (&a_angles)[3])
+	{
+		const auto& R = a_rot;
+		if (R[1][2] <= 0.99999f && R[1][2] >= -0.99999f) {
+			// normal case, both atan2 share one vector call
+			alignas(16) float atans[4];
+			_mm_store_ps(atans, ATan2(_mm_setr_ps(R[0][2], R[1][0], 0.f, 0.f), _mm_setr_ps(R[2][2], R[1][1], 1.f, 1.f)));
+
+			a_angles[0] = _mm_cvtss_f32(ASin(_mm_set_ss(-R[1][2])));
+			a_angles[1] = atans[0];
+			a_angles[2] = atans[1];
+		} else {
+			// gimbal lock, x = 90 degrees for -R[1][2] = 1, -90 degrees for -1
+			// y and z turn about the same axis, for either sign R[0][0] = cos(z), R[0][1] = -sin(z) once y is 0
+			a_angles[0] = R[1][2] < 0.f ? HALF_PI : -HALF_PI;
+			a_angles[1] = 0.f;
+			a_angles[2] = _mm_cvtss_f32(ATan2(_mm_set_ss(-R[0][1]), _mm_set_ss(R[0][0])));
+		}
+	}
+
+	inline void EulerYXZToMat(float (&a_rot)[3][3], const float (&a_angles)[3])
+	{
+		auto& R = a_rot;
+
+		__m128 sines;
+		__m128 cosines;
+		SinCos(_mm_setr_ps(a_angles[0], a_angles[1], a_angles[2], 0.f), sines, cosines);
+
+		alignas(16) float s[4];
+		alignas(16) float c[4];
+		_mm_store_ps(s, sines);
+		_mm_store_ps(c, cosines);
+
+		const float cx = c[0], sx = s[0];
+		const float cy = c[1], sy = s[1];
+		const float cz = c[2], sz = s[2];
+
+		R[0][0] = cy * cz + sx * sy * sz;
+		R[0][1] = cz * sx * sy - cy * sz;
+		R[0][2] = cx * sy;
+
+		R[1][0] = cx * sz;
+		R[1][1] = cx * cz;
+		R[1][2] = -sx;
+
+		R[2][0] = cy * sx * sz - cz * sy;
+		R[2][1] = cy * cz * sx + sy * sz;
+		R[2][2] = cx * cy;
+	}
+}
@@ -0,0 +1,136 @@
+#include "Fingerprint.h"
+#include "Util.h"
+
+using namespace PAR;
+
+namespace
+{
+	// FNV-1a
+	void HashValue(std::uint64_t& a_hash, std::uint64_t a_value)
+	{
+		for (int i = 0; i < 8; ++i) {
+			a_hash ^= (a_value >> (i * 8)) & 0xFF;
+			a_hash *= 0x100000001b3ull;
+		}
+	}
+
+	std::uint64_t GetFormID(const RE::TESForm* a_form)
+	{
+		return a_form ? a_form->GetFormID() : 0;
+	}
+}
+
+void Fingerprint::BuildFunctionTable()
+{
+	// functions answered by the base and race alone, both are part of every fingerprint
+	// faction membership, ranks and keywords can change at runtime and are left out, which makes them uncacheable
+	constexpr std::array identity{
+		"GetIsRace"sv, "GetIsSex"sv, "GetIsID"sv, "GetIsVoiceType"sv, "GetIsClass"sv, "IsChild"sv
+	};
+
+	constexpr std::array<std::pair<std::string_view, Feature>, 14> dynamic{ {
+		{ "GetInCell"sv, kCell },
+		{ "GetInCurrentLoc"sv, kCell },
+		{ "IsInInterior"sv, kCell },
+		{ "IsInCombat"sv, kCombat },
+		{ "GetCombatState"sv, kCombat },
+		{ "IsWeaponOut"sv, kWeaponDrawn },
+		{ "IsWeaponMagicOut"sv, kWeaponDrawn },
+		{ "IsSneaking"sv, kSneaking },
+		{ "GetEquipped"sv, kEquipment },
+		{ "WornHasKeyword"sv, kEquipment },
+		{ "GetEquippedItemType"sv, kEquipment },
+		{ "GetSitting"sv, kSitting },
+		{ "IsSwimming"sv, kSwimming },
+		{ "IsRidingMount"sv, kMount },
+	} };
+
+	const auto add = [](std::string_view a_name, std::uint32_t a_features) {
+		if (const auto function = RE::SCRIPT_FUNCTION::LocateScriptCommand(a_name.data())) {
+			_functions[static_cast<std::uint16_t>(Util::to_underlying(function->output) - 0x1000)] = a_features;
+		}
+	};
+
+	for (const auto name : identity) {
+		add(name, kNone);
+	}
+
+	for (const auto& [name, feature] : dynamic) {
+		add(name, feature);
+	}
+}
+
+std::uint32_t Fingerprint::GetFeatures(const RE::TESCondition* a_condition)
+{
+	std::call_once(_init, BuildFunctionTable);
+
+	if (!a_condition)
+		return kNone;
+
+	std::uint32_t features = kNone;
+	for (auto item = a_condition->head; item; item = item->next) {
+		// other references and globals can change without the actor changing
+		if (item->data.object != RE::CONDITIONITEMOBJECT::kSelf || item->data.flags.global)
+			return kUncacheable;
+
+		const auto iter = _functions.find(static_cast<std::uint16_t>(item->data.functionData.function.underlying()));
+		if (iter == _functions.end())
+			return kUncacheable;
+
+		features |= iter->second;
+	}
+
+	return features;
+}
+
+std::uint64_t Fingerprint::Compute(RE::Actor* a_actor, std::uint32_t a_features)
+{
+	std::uint64_t hash = 0xcbf29ce484222325ull;
+
+	HashValue(hash, a_actor->GetFormID());
+	HashValue(hash, GetFormID(a_actor->GetActorBase()));
+	HashValue(hash, GetFormID(a_actor->GetRace()));
+
+	const auto state = a_actor->AsActorState();
+
+	if (a_features & kCell) {
+		HashValue(hash, GetFormID(a_actor->GetParentCell()));
+	}
+
+	if (a_features & kCombat) {
+		HashValue(hash, a_actor->IsInCombat());
+	}
+
+	if (a_features & kWeaponDrawn) {
+		HashValue(hash, state->IsWeaponDrawn());
+	}
+
+	if (a_features & kSneaking) {
+		HashValue(hash, a_actor->IsSneaking());
+	}
+
+	if (a_features & kEquipment) {
+		HashValue(hash, GetFormID(a_actor->GetEquippedObject(true)));
+		HashValue(hash, GetFormID(a_actor->GetEquippedObject(false)));
+
+		if (const auto& biped = a_actor->GetBiped(false)) {
+			for (const auto& object : biped->objects) {
+				HashValue(hash, GetFormID(object.item));
+			}
+		}
+	}
+
+	if (a_features & kSitting) {
+		HashValue(hash, Util::to_underlying(state->GetSitSleepState()));
+	}
+
+	if (a_features & kSwimming) {
+		HashValue(hash, state->IsSwimming());
+	}
+
+	if (a_features & kMount) {
+		HashValue(hash, a_actor->IsOnMount());
+	}
+
+	return hash;
+}
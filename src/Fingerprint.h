@@ -0,0 +1,35 @@
+#pragma once
+
+namespace PAR
+{
+	// Cheap per-actor hash over the state the loaded conditions can observe
+	class Fingerprint
+	{
+	public:
+		enum Feature : std::uint32_t
+		{
+			kNone = 0,
+			kCell = 1 << 0,
+			kCombat = 1 << 1,
+			kWeaponDrawn = 1 << 2,
+			kSneaking = 1 << 3,
+			kEquipment = 1 << 4,
+			kSitting = 1 << 5,
+			kSwimming = 1 << 6,
+			kMount = 1 << 7,
+
+			// a condition depends on state that isn't part of the fingerprint
+			kUncacheable = 1u << 31
+		};
+
+		static std::uint32_t GetFeatures(const RE::TESCondition* a_condition);
+		static std::uint64_t Compute(RE::Actor* a_actor, std::uint32_t a_features);
+
+	private:
+		static void BuildFunctionTable();
+
+		// condition function id to the features it reads, identity-only functions map to kNone
+		static inline std::unordered_map<std::uint16_t, std::uint32_t> _functions;
+		static inline std::once_flag _init;
+	};
+}
@@ -0,0 +1,78 @@
+#include "FramePool.h"
+
+using namespace PAR;
+
+namespace
+{
+	// FNV-1a
+	void HashBytes(std::uint64_t& a_hash, const void* a_data, std::size_t a_size)
+	{
+		const auto bytes = static_cast<const std::uint8_t*>(a_data);
+		for (std::size_t i = 0; i < a_size; ++i) {
+			a_hash ^= bytes[i];
+			a_hash *= 0x100000001b3ull;
+		}
+	}
+}
+
+std::uint64_t FramePool::Hash(const Frame& a_frame)
+{
+	std::uint64_t hash = 0xcbf29ce484222325ull;
+	for (const auto& override : a_frame) {
+		HashBytes(hash, &override.bone, sizeof(override.bone));
+		HashBytes(hash, &override.transform, sizeof(override.transform));
+	}
+	return hash;
+}
+
+bool FramePool::Equals(const Frame& a_lhs, const Frame& a_rhs)
+{
+	return std::ranges::equal(a_lhs, a_rhs, [](const Override& a, const Override& b) {
+		return a.bone == b.bone && std::memcmp(&a.transform, &b.transform, sizeof(RE::NiTransform)) == 0;
+	});
+}
+
+FramePtr FramePool::Intern(Frame&& a_frame)
+{
+	const auto hash = Hash(a_frame);
+
+	// released after the lock, the last reference to a compared frame would run Release under it
+	std::vector<FramePtr> compared;
+
+	std::unique_lock lock{ _buckets->mutex };
+
+	auto& bucket = _buckets->frames[hash];
+	for (const auto& weak : bucket) {
+		if (auto frame = weak.lock()) {
+			if (Equals(*frame, a_frame)) {
+				_shared += 1;
+				return frame;
+			}
+			compared.push_back(std::move(frame));
+		}
+	}
+
+	FramePtr frame{ new Frame(std::move(a_frame)), [buckets = _buckets, hash](const Frame* a_released) {
+		Release(*buckets, hash, a_released);
+	} };
+	bucket.push_back(frame);
+	_interned += 1;
+
+	return frame;
+}
+
+void FramePool::Release(Buckets& a_buckets, std::uint64_t a_hash, const Frame* a_frame)
+{
+	{
+		std::unique_lock lock{ a_buckets.mutex };
+
+		if (const auto iter = a_buckets.frames.find(a_hash); iter != a_buckets.frames.end()) {
+			std::erase_if(iter->second, [](const auto& weak) { return weak.expired(); });
+			if (iter->second.empty()) {
+				a_buckets.frames.erase(iter);
+			}
+		}
+	}
+
+	delete a_frame;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "BoneTable.h"
+
+namespace PAR
+{
+	struct Override
+	{
+		BoneID bone;
+		RE::NiTransform transform;
+	};
+
+	typedef std::vector<Override> Frame;
+	typedef std::shared_ptr<const Frame> FramePtr;
+
+	// Deduplicates bit-identical frames across all loaded replacers
+	class FramePool
+	{
+	public:
+		static FramePtr Intern(Frame&& a_frame);
+
+		static std::size_t GetInternedCount() { return _interned; }
+		static std::size_t GetSharedCount() { return _shared; }
+
+	private:
+		struct Buckets
+		{
+			std::mutex mutex;
+			std::unordered_map<std::uint64_t, std::vector<std::weak_ptr<const Frame>>> frames;
+		};
+
+		static std::uint64_t Hash(const Frame& a_frame);
+		static bool Equals(const Frame& a_lhs, const Frame& a_rhs);
+
+		// deleter of every interned frame, drops its entry and the bucket once that is empty
+		static void Release(Buckets& a_buckets, std::uint64_t a_hash, const Frame* a_frame);
+
+		// shared with the deleters, frames may outlive the pool's static destructor
+		static inline std::shared_ptr<Buckets> _buckets = std::make_shared<Buckets>();
+		static inline std::size_t _interned = 0;
+		static inline std::size_t _shared = 0;
+	};
+}
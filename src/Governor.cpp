@@ -0,0 +1,40 @@
+#include "Governor.h"
+
+#include <utility>
+
+using namespace PAR;
+
+void Governor::Configure(const Config& a_config)
+{
+	_config = a_config;
+	_level = Level::kFull;
+	_over = 0;
+	_under = 0;
+}
+
+bool Governor::Update(std::chrono::nanoseconds a_cost)
+{
+	if (_config.budgetUs <= 0.f)
+		return false;
+
+	const auto costUs = std::chrono::duration<float, std::micro>(a_cost).count();
+	const auto level = std::to_underlying(GetLevel());
+
+	// a frame between the thresholds breaks both streaks, that gap is the hysteresis
+	_over = costUs > _config.budgetUs ? _over + 1 : 0;
+	_under = costUs < _config.budgetUs * _config.recoverRatio ? _under + 1 : 0;
+
+	if (_over >= _config.degradeFrames && level + 1 < std::to_underlying(Level::kTotal)) {
+		_level = static_cast<Level>(level + 1);
+	} else if (_under >= _config.recoverFrames && level > 0) {
+		_level = static_cast<Level>(level - 1);
+	} else {
+		return false;
+	}
+
+	// the cost measured at the new level says nothing about the old one
+	_over = 0;
+	_under = 0;
+
+	return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace PAR
+{
+	// Trades replacer fidelity for frame time, steps down a level while the apply cost stays over budget
+	// Only fed with measured costs, so it can be driven by a synthetic cost model outside the game
+	class Governor
+	{
+	public:
+		enum class Level : std::uint32_t
+		{
+			kFull,
+			kNearLimits,  // limits only run on actors close to the player
+			kHalfRate,    // each NPC is evaluated every other frame, alternating by form id, and holds its last pose in between
+			kPlayerOnly,
+
+			kTotal
+		};
+
+		struct Config
+		{
+			// 0 disables the governor
+			float budgetUs = 0.f;
+
+			// a level is only restored while the cost stays below this fraction of the budget
+			float recoverRatio = 0.6f;
+
+			// consecutive frames over the budget, or under the recovery threshold, before a level changes
+			std::uint32_t degradeFrames = 5;
+			std::uint32_t recoverFrames = 120;
+		};
+
+		void Configure(const Config& a_config);
+
+		// feeds the cost of one frame, returns true if the level changed
+		bool Update(std::chrono::nanoseconds a_cost);
+
+		Level GetLevel() const { return _level.load(std::memory_order_relaxed); }
+
+	private:
+		Config _config;
+
+		// read from Papyrus threads
+		std::atomic<Level> _level = Level::kFull;
+
+		std::uint32_t _over = 0;
+		std::uint32_t _under = 0;
+	};
+}
@@ -1,6 +1,9 @@
 #include "Hooks.h"
 #include "ReplacerManager.h"
 #include "Dumper.h"
+#include "Benchmark.h"
+#include "Tracer.h"
+#include "StatsExport.h"
 
 using namespace PAR;
 
@@ -23,9 +26,27 @@ namespace
 	{
 		static void thunk(RE::NiAVObject* a_obj, RE::NiUpdateData* updateData)
 		{
-			ReplacerManager::ApplyReplacers(a_obj);
+			Tracer::SetThreadName("main");
+			TRACE_SCOPE("UpdateThirdPerson");
+
+			const auto start = std::chrono::steady_clock::now();
+			if (ReplacerManager::IsReady()) {
+				ReplacerManager::ApplyReplacers(a_obj);
+			}
+			const auto applied = std::chrono::steady_clock::now();
+
 			func(a_obj, updateData);
+
+			const auto updated = std::chrono::steady_clock::now();
 			Dumper::OnFrame();
+
+			const auto cost = (applied - start) + (std::chrono::steady_clock::now() - updated);
+
+			if (Benchmark::IsRunning()) {
+				Benchmark::RecordFrame(cost);
+			}
+
+			StatsExport::RecordFrame(cost);
 		}
 		static inline REL::Relocation<decltype(thunk)> func;
 		static inline constexpr std::size_t size{ 5 };
@@ -51,11 +72,15 @@ void Hooks::UpdatePlayer(RE::Actor* a_actor, float a_delta)
 	_UpdatePlayer(a_actor, a_delta);
 	_lastUpdated += a_delta;
 
+	if (!ReplacerManager::IsReady())
+		return;
+
 	if (!_loaded || _lastUpdated >= TIME_DELTA) {
 		_loaded = true;
 		_lastUpdated = 0.f;
 
 		std::thread([]() {
+			Tracer::SetThreadName("evaluation");
 			ReplacerManager::EvaluateReplacers();
 		}).detach();
 	}
@@ -0,0 +1,221 @@
+#include "Kernel.h"
+#include "KernelPlan.h"
+
+#include <random>
+
+using namespace PAR;
+
+namespace
+{
+	// upper bounds of the encoded size of each part
+	constexpr std::size_t PROLOGUE_SIZE = 64;
+	constexpr std::size_t OVERRIDE_SIZE = 13 * 12 + 8;
+	constexpr std::size_t LIMIT_SIZE = 7 * 48;
+
+	std::uint32_t Bits(float a_value)
+	{
+		return std::bit_cast<std::uint32_t>(a_value);
+	}
+}
+
+std::unique_ptr<Kernel> Kernel::Build(const std::vector<PoseOverride>& a_overrides, const std::vector<LiveLimit>& a_limits)
+{
+	const auto size = PROLOGUE_SIZE + a_overrides.size() * OVERRIDE_SIZE + a_limits.size() * LIMIT_SIZE;
+
+	try {
+		return std::unique_ptr<Kernel>(new Kernel(size, a_overrides, a_limits));
+	} catch (const Xbyak::Error& e) {
+		logger::error("failed to build kernel - {}", e.what());
+		return nullptr;
+	}
+}
+
+// Windows x64 ABI: rcx holds a_transforms, rbx keeps it across the helper calls
+// Every decision is made by KernelPlan::Build, each op lowers to the same instructions whatever it holds
+Kernel::Kernel(std::size_t a_size, const std::vector<PoseOverride>& a_overrides, const std::vector<LiveLimit>& a_limits) :
+	Xbyak::CodeGenerator(a_size)
+{
+	for (const auto& override : a_overrides) {
+		_bones.push_back(override.bone);
+	}
+
+	_limits.reserve(a_limits.size());
+	for (const auto& live : a_limits) {
+		_bones.push_back(live.limit->bone);
+		_limits.push_back(*live.limit);
+	}
+
+	push(rbx);
+	sub(rsp, 32);  // shadow space, keeps rsp 16-byte aligned at the calls
+	mov(rbx, rcx);
+
+	// the transform rax points at, the helpers clobber it
+	constexpr auto NONE = std::numeric_limits<std::uint32_t>::max();
+	auto loaded = NONE;
+
+	for (const auto& op : KernelPlan::Build<RE::NiTransform>(a_overrides, a_limits)) {
+		switch (op.kind) {
+		case KernelPlan::Op::Kind::kStore:
+			if (loaded != op.index) {
+				mov(rax, qword[rbx + op.index * sizeof(void*)]);
+				loaded = op.index;
+			}
+			mov(dword[rax + op.offset], op.bits);
+			break;
+		case KernelPlan::Op::Kind::kSaturateRotation:
+			mov(rcx, qword[rbx + op.index * sizeof(void*)]);
+			add(rcx, op.offset);
+			mov(rdx, reinterpret_cast<std::uintptr_t>(std::addressof(_limits[op.limit])));
+			mov(rax, reinterpret_cast<std::uintptr_t>(&SaturateRotation));
+			call(rax);
+			loaded = NONE;
+			break;
+		case KernelPlan::Op::Kind::kSaturateValue:
+			mov(rcx, qword[rbx + op.index * sizeof(void*)]);
+			add(rcx, op.offset);
+			mov(eax, Bits(op.lo));
+			movd(xmm1, eax);
+			mov(eax, Bits(op.hi));
+			movd(xmm2, eax);
+			mov(rax, reinterpret_cast<std::uintptr_t>(&SaturateValue));
+			call(rax);
+			loaded = NONE;
+			break;
+		}
+	}
+
+	add(rsp, 32);
+	pop(rbx);
+	ret();
+
+	ready();
+	_func = getCode<Func>();
+}
+
+void Kernel::SaturateRotation(RE::NiMatrix3* a_rotate, const Limit* a_limit)
+{
+	TransformOps::SaturateRotation(a_rotate->entry, *a_limit);
+}
+
+void Kernel::SaturateValue(float* a_value, float a_lo, float a_hi)
+{
+	*a_value = TransformOps::Saturate(*a_value, a_lo, a_hi);
+}
+
+// The reference path, same as ReplacerManager::ApplyReplacersToActor without a kernel
+void Kernel::Interpret(const std::vector<PoseOverride>& a_overrides, RE::NiTransform* const* a_overrideTransforms,
+	const std::vector<LiveLimit>& a_limits, RE::NiTransform* const* a_limitTransforms)
+{
+	for (std::size_t i = 0; i < a_overrides.size(); ++i) {
+		Replacer::ApplyOverride(*a_overrideTransforms[i], a_overrides[i]);
+	}
+
+	for (std::size_t i = 0; i < a_limits.size(); ++i) {
+		Replacer::ApplyLimit(*a_limitTransforms[i], *a_limits[i].limit, a_limits[i].channels);
+	}
+}
+
+bool Kernel::Verify(const Kernel& a_kernel, const Replacer& a_replacer, bool a_limits, const std::string& a_name)
+{
+	constexpr int SAMPLES = 64;
+	constexpr int ITERATIONS = 1000;
+	constexpr float TOLERANCE = 1e-5f;
+
+	// composed again, the kernel's own inputs would hide a mistake made while composing them
+	std::vector<PoseOverride> overrides;
+	std::vector<LiveLimit> limits;
+	const auto payload = a_replacer.Compose(overrides, limits);
+	if (!payload) {
+		logger::error("{}: nothing to verify the kernel against", a_name);
+		return false;
+	}
+
+	if (!a_limits) {
+		limits.clear();
+	}
+
+	const auto& bones = a_kernel.GetBones();
+	const auto count = bones.size();
+
+	std::vector<RE::NiTransform> input(count);
+	std::vector<RE::NiTransform> jitted(count);
+	std::vector<RE::NiTransform> interpreted(count);
+	std::vector<RE::NiTransform*> jittedArgs(count);
+
+	for (std::size_t i = 0; i < count; ++i) {
+		jittedArgs[i] = std::addressof(jitted[i]);
+	}
+
+	// the interpreted path finds its transforms by bone, like Pose::Get
+	const auto find = [&](BoneID a_bone) -> RE::NiTransform* {
+		const auto iter = std::ranges::find(bones, a_bone);
+		return iter != bones.end() ? std::addressof(interpreted[static_cast<std::size_t>(iter - bones.begin())]) : nullptr;
+	};
+
+	std::vector<RE::NiTransform*> overrideArgs;
+	for (const auto& override : overrides) {
+		overrideArgs.push_back(find(override.bone));
+	}
+
+	std::vector<RE::NiTransform*> limitArgs;
+	for (const auto& live : limits) {
+		limitArgs.push_back(find(live.limit->bone));
+	}
+
+	if (count != overrides.size() + limits.size() || std::ranges::count(overrideArgs, nullptr) || std::ranges::count(limitArgs, nullptr)) {
+		logger::error("{}: kernel covers {} bones, the composed pose {} overrides and {} limits", a_name, count, overrides.size(), limits.size());
+		return false;
+	}
+
+	std::mt19937 rng{ 0x50415221 };
+	std::uniform_real_distribution angle{ -RE::NI_PI, RE::NI_PI };
+	std::uniform_real_distribution offset{ -20.f, 20.f };
+	std::uniform_real_distribution scale{ 0.5f, 1.5f };
+
+	for (int sample = 0; sample < SAMPLES; ++sample) {
+		for (auto& transform : input) {
+			transform.rotate.SetEulerAnglesXYZ(angle(rng), angle(rng), angle(rng));
+			transform.translate = RE::NiPoint3{ offset(rng), offset(rng), offset(rng) };
+			transform.scale = scale(rng);
+		}
+
+		jitted = input;
+		interpreted = input;
+
+		a_kernel(jittedArgs.data());
+		Interpret(overrides, overrideArgs.data(), limits, limitArgs.data());
+
+		for (std::size_t i = 0; i < count; ++i) {
+			const auto& lhs = jitted[i];
+			const auto& rhs = interpreted[i];
+
+			float error = std::abs(lhs.scale - rhs.scale);
+			for (std::size_t k = 0; k < 3; ++k) {
+				error = std::max(error, std::abs(lhs.translate[k] - rhs.translate[k]));
+				for (std::size_t l = 0; l < 3; ++l) {
+					error = std::max(error, std::abs(lhs.rotate.entry[k][l] - rhs.rotate.entry[k][l]));
+				}
+			}
+
+			if (!(error <= TOLERANCE)) {
+				logger::error("{}: kernel differs from the interpreter by {} on {}", a_name, error, BoneTable::GetName(bones[i]));
+				return false;
+			}
+		}
+	}
+
+	const auto time = [&](auto&& a_run) {
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < ITERATIONS; ++i) {
+			a_run();
+		}
+		return std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - start).count() / ITERATIONS;
+	};
+
+	const auto jitNs = time([&]() { a_kernel(jittedArgs.data()); });
+	const auto interpreterNs = time([&]() { Interpret(overrides, overrideArgs.data(), limits, limitArgs.data()); });
+
+	logger::info("{}: kernel verified, {:.0f}ns vs {:.0f}ns interpreted ({} bones)", a_name, jitNs, interpreterNs, count);
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Replacer.h"
+
+namespace PAR
+{
+	// Straight-line x64 code for one replacer, with its composed overrides and live limits baked in
+	class Kernel : public Xbyak::CodeGenerator
+	{
+	public:
+		typedef void (*Func)(RE::NiTransform* const* a_transforms);
+
+		static std::unique_ptr<Kernel> Build(const std::vector<PoseOverride>& a_overrides, const std::vector<LiveLimit>& a_limits);
+
+		// runs the kernel and the interpreted path of ApplyReplacersToActor, from a fresh Replacer::Compose, on the
+		// same random poses and logs both timings
+		static bool Verify(const Kernel& a_kernel, const Replacer& a_replacer, bool a_limits, const std::string& a_name);
+
+		// a_transforms holds one transform per bone of GetBones(), in order
+		void operator()(RE::NiTransform* const* a_transforms) const { _func(a_transforms); }
+
+		const std::vector<BoneID>& GetBones() const { return _bones; }
+
+	private:
+		Kernel(std::size_t a_size, const std::vector<PoseOverride>& a_overrides, const std::vector<LiveLimit>& a_limits);
+
+		static void Interpret(const std::vector<PoseOverride>& a_overrides, RE::NiTransform* const* a_overrideTransforms,
+			const std::vector<LiveLimit>& a_limits, RE::NiTransform* const* a_limitTransforms);
+
+		static void SaturateRotation(RE::NiMatrix3* a_rotate, const Limit* a_limit);
+		static void SaturateValue(float* a_value, float a_lo, float a_hi);
+
+		std::vector<BoneID> _bones;
+
+		// the generated code points into these, never resized after construction
+		std::vector<Limit> _limits;
+
+		Func _func = nullptr;
+	};
+}
\ No newline at end of file
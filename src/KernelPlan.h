@@ -0,0 +1,123 @@
+#pragma once
+
+#include "TransformOps.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// The operations of a kernel, decided without emitting any code, free of game types
+// Kernel lowers each op to the same few instructions and makes no decisions of its own, tools/Tests runs the plan
+// with Run against the interpreter
+
+namespace PAR::KernelPlan
+{
+	struct Op
+	{
+		enum class Kind : std::uint8_t
+		{
+			kStore,             // writes bits at offset
+			kSaturateRotation,  // TransformOps::SaturateRotation on the matrix at offset with limits[limit]
+			kSaturateValue      // TransformOps::Saturate on the float at offset between lo and hi
+		};
+
+		Kind kind;
+		std::uint32_t index;  // of the transform
+		std::uint32_t offset;  // into the transform
+		std::uint32_t bits = 0;
+		std::uint32_t limit = 0;
+		float lo = 0.f;
+		float hi = 0.f;
+	};
+
+	// Transform is the layout the offsets are taken from, the overrides come first, then a transform per limit
+	// Degenerate ranges, which Saturate leaves alone, produce no op
+	template <class Transform, class Override, class LiveLimit>
+	std::vector<Op> Build(const std::vector<Override>& a_overrides, const std::vector<LiveLimit>& a_limits)
+	{
+		std::vector<Op> ops;
+
+		const auto store = [&](std::uint32_t a_index, std::size_t a_offset, float a_value) {
+			ops.push_back(Op{ Op::Kind::kStore, a_index, static_cast<std::uint32_t>(a_offset), std::bit_cast<std::uint32_t>(a_value) });
+		};
+
+		const auto saturate = [&](std::uint32_t a_index, std::size_t a_offset, float a_lo, float a_hi) {
+			if (a_lo < a_hi) {
+				ops.push_back(Op{ Op::Kind::kSaturateValue, a_index, static_cast<std::uint32_t>(a_offset), 0, 0, a_lo, a_hi });
+			}
+		};
+
+		for (std::uint32_t i = 0; i < a_overrides.size(); ++i) {
+			const auto& override = a_overrides[i];
+			const auto& transform = override.transform;
+
+			if (override.channels & kRotate) {
+				for (std::size_t row = 0; row < 3; ++row) {
+					for (std::size_t col = 0; col < 3; ++col) {
+						store(i, offsetof(Transform, rotate) + (row * 3 + col) * sizeof(float), transform.rotate.entry[row][col]);
+					}
+				}
+			}
+
+			if (override.channels & kTranslate) {
+				for (std::size_t axis = 0; axis < 3; ++axis) {
+					store(i, offsetof(Transform, translate) + axis * sizeof(float), transform.translate[axis]);
+				}
+			}
+
+			if (override.channels & kScale) {
+				store(i, offsetof(Transform, scale), transform.scale);
+			}
+		}
+
+		for (std::uint32_t k = 0; k < a_limits.size(); ++k) {
+			const auto index = static_cast<std::uint32_t>(a_overrides.size()) + k;
+			const auto& limit = *a_limits[k].limit;
+			const auto channels = a_limits[k].channels;
+
+			if ((channels & kRotate) && TransformOps::HasRotationRange(limit)) {
+				ops.push_back(Op{ Op::Kind::kSaturateRotation, index, static_cast<std::uint32_t>(offsetof(Transform, rotate)), 0, k });
+			}
+
+			if (channels & kTranslate) {
+				for (std::size_t axis = 0; axis < 3; ++axis) {
+					saturate(index, offsetof(Transform, translate) + axis * sizeof(float), limit.translate_low[axis], limit.translate_high[axis]);
+				}
+			}
+
+			if (channels & kScale) {
+				saturate(index, offsetof(Transform, scale), limit.scale_low, limit.scale_high);
+			}
+		}
+
+		return ops;
+	}
+
+	// What the emitted code does, op by op, on one transform per bone
+	template <class Transform, class Limit>
+	void Run(const std::vector<Op>& a_ops, const std::vector<Limit>& a_limits, Transform* const* a_transforms)
+	{
+		for (const auto& op : a_ops) {
+			const auto address = reinterpret_cast<std::byte*>(a_transforms[op.index]) + op.offset;
+
+			switch (op.kind) {
+			case Op::Kind::kStore:
+				std::memcpy(address, &op.bits, sizeof(op.bits));
+				break;
+			case Op::Kind::kSaturateRotation:
+				TransformOps::SaturateRotation(*reinterpret_cast<float(*)[3][3]>(address), a_limits[op.limit]);
+				break;
+			case Op::Kind::kSaturateValue:
+				{
+					float value;
+					std::memcpy(&value, address, sizeof(value));
+					value = TransformOps::Saturate(value, op.lo, op.hi);
+					std::memcpy(address, &value, sizeof(value));
+				}
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+
+namespace PAR
+{
+	// Unbounded multi-producer single-consumer queue, Push never blocks and Pop is wait-free
+	// An item becomes visible to the consumer once its producer has linked it, at the latest on the next Pop
+	template <class T>
+	class MPSCQueue
+	{
+	public:
+		MPSCQueue() :
+			_head(new Node{}), _tail(_head.load(std::memory_order_relaxed))
+		{}
+
+		~MPSCQueue()
+		{
+			while (Pop()) {}
+			delete _tail;
+		}
+
+		MPSCQueue(const MPSCQueue&) = delete;
+		MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+		// any thread
+		void Push(T a_value)
+		{
+			const auto node = new Node{ {}, std::move(a_value) };
+			const auto prev = _head.exchange(node, std::memory_order_acq_rel);
+			prev->next.store(node, std::memory_order_release);
+		}
+
+		// consumer thread only
+		std::optional<T> Pop()
+		{
+			const auto next = _tail->next.load(std::memory_order_acquire);
+			if (!next)
+				return std::nullopt;
+
+			auto value = std::move(next->value);
+			next->value.reset();
+
+			// the consumed node becomes the new stub
+			delete _tail;
+			_tail = next;
+
+			return value;
+		}
+
+	private:
+		struct Node
+		{
+			std::atomic<Node*> next{ nullptr };
+			std::optional<T> value;
+		};
+
+		std::atomic<Node*> _head;
+		Node* _tail;
+	};
+}
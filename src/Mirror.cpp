@@ -0,0 +1,82 @@
+#include "Mirror.h"
+
+namespace PAR::Mirror
+{
+	std::string GetName(std::string_view a_name)
+	{
+		std::string name{ a_name };
+
+		// the side is the standalone L or R word, a name without one is unsided and stays as it is
+		char side = 0;
+		for (std::size_t i = 0; i < name.size(); ++i) {
+			const char prev = i > 0 ? name[i - 1] : ' ';
+			const char next = i + 1 < name.size() ? name[i + 1] : ' ';
+
+			if ((name[i] == 'L' || name[i] == 'R') && prev == ' ' && next == ' ') {
+				side = name[i];
+				break;
+			}
+		}
+
+		if (!side)
+			return name;
+
+		const char other = side == 'L' ? 'R' : 'L';
+
+		// every side word, and the bracketed abbreviations starting with the same side, "[Root]" never does
+		for (std::size_t i = 0; i < name.size(); ++i) {
+			if (name[i] != side)
+				continue;
+
+			const char prev = i > 0 ? name[i - 1] : ' ';
+			const char next = i + 1 < name.size() ? name[i + 1] : ' ';
+
+			if ((prev == ' ' && next == ' ') || prev == '[') {
+				name[i] = other;
+			}
+		}
+
+		return name;
+	}
+
+	BoneID GetBone(BoneID a_bone)
+	{
+		if (a_bone == BoneTable::INVALID_BONE)
+			return a_bone;
+
+		return BoneTable::Intern(GetName(BoneTable::GetName(a_bone)));
+	}
+
+	// M R M with M = diag(-1, 1, 1), every entry mixing x with another axis flips
+	void Reflect(RE::NiMatrix3& a_rotate)
+	{
+		auto& R = a_rotate.entry;
+		R[0][1] = -R[0][1];
+		R[0][2] = -R[0][2];
+		R[1][0] = -R[1][0];
+		R[2][0] = -R[2][0];
+	}
+
+	void Reflect(RE::NiTransform& a_transform)
+	{
+		Reflect(a_transform.rotate);
+		a_transform.translate.x = -a_transform.translate.x;
+	}
+
+	// rotations about y and z change direction, a degenerate range stays degenerate
+	Limit Reflect(const Limit& a_limit)
+	{
+		auto limit = a_limit;
+		limit.bone = GetBone(a_limit.bone);
+
+		for (std::size_t axis = 1; axis < 3; ++axis) {
+			limit.rotate_low[axis] = -a_limit.rotate_high[axis];
+			limit.rotate_high[axis] = -a_limit.rotate_low[axis];
+		}
+
+		limit.translate_low[0] = -a_limit.translate_high[0];
+		limit.translate_high[0] = -a_limit.translate_low[0];
+
+		return limit;
+	}
+}
\ No newline at end of file
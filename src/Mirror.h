@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Replacer.h"
+
+// Left/right reflection of replacer data, across the plane of the local y and z axes
+
+namespace PAR::Mirror
+{
+	// swaps the side markers of Skyrim's bone names, "NPC L Forearm [LLar]" <-> "NPC R Forearm [RLar]"
+	// names without a standalone L or R word are returned unchanged
+	std::string GetName(std::string_view a_name);
+	BoneID GetBone(BoneID a_bone);
+
+	void Reflect(RE::NiMatrix3& a_rotate);
+	void Reflect(RE::NiTransform& a_transform);
+	Limit Reflect(const Limit& a_limit);
+}
\ No newline at end of file
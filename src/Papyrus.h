@@ -2,6 +2,10 @@
 
 #include "ReplacerManager.h"
 #include "Dumper.h"
+#include "Benchmark.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "Recorder.h"
 
 constexpr std::string_view PapyrusClass = "PartialAnimationReplacer";
 
@@ -34,7 +38,74 @@ namespace
 			a_nodes += ".json";
 		}
 
-		return Dumper::QueueDump(a_actor, a_dir, a_name, a_nodes, a_target, a_rotate, a_translate, a_scale);
+		return Dumper::QueueDump({ a_actor }, a_dir, { a_name }, a_nodes, a_target, a_rotate, a_translate, a_scale);
+	}
+
+	// records all actors on the same frames, a_names[i] is the file written for a_actors[i]
+	inline bool DumpScene(RE::StaticFunctionTag*, std::vector<RE::Actor*> a_actors, std::string a_dir, std::vector<std::string> a_names, std::string a_nodes, int a_target, bool a_rotate, bool a_translate, bool a_scale)
+	{
+		for (auto& name : a_names) {
+			if (!name.ends_with(".json")) {
+				name += ".json";
+			}
+		}
+
+		if (!a_nodes.ends_with(".json")) {
+			a_nodes += ".json";
+		}
+
+		return Dumper::QueueDump(a_actors, a_dir, a_names, a_nodes, a_target, a_rotate, a_translate, a_scale);
+	}
+
+	inline bool StartBenchmark(RE::StaticFunctionTag*, int a_frames, float a_maxFrameUs, float a_maxEvalUs)
+	{
+		return Benchmark::Start(a_frames, a_maxFrameUs, a_maxEvalUs);
+	}
+
+	inline void BenchmarkLoader(RE::StaticFunctionTag*, std::string a_dir, std::string a_name)
+	{
+		if (!a_name.ends_with(".json")) {
+			a_name += ".json";
+		}
+
+		Benchmark::CompareLoaders("Data\\SKSE\\PartialAnimationReplacer\\Replacers\\" + a_dir + "\\" + a_name);
+	}
+
+	inline void BenchmarkPoseLookup(RE::StaticFunctionTag*, int a_frames, int a_keyBones)
+	{
+		Benchmark::ComparePoseLookup(a_frames, a_keyBones);
+	}
+
+	// 0 is full quality, higher levels trade fidelity for frame time, see Governor::Level
+	inline int GetQualityLevel(RE::StaticFunctionTag*)
+	{
+		return static_cast<int>(ReplacerManager::GetQualityLevel());
+	}
+
+	inline void LogStats(RE::StaticFunctionTag*, bool a_reset)
+	{
+		Profiler::LogReport(a_reset);
+	}
+
+	inline void StartTrace(RE::StaticFunctionTag*)
+	{
+		Tracer::Start();
+	}
+
+	inline bool StopTrace(RE::StaticFunctionTag*, std::string a_name)
+	{
+		return Tracer::Stop(a_name);
+	}
+
+	// written next to the log, replayed offline by tools/SelectionReplay
+	inline bool StartRecording(RE::StaticFunctionTag*, std::string a_name)
+	{
+		return Recorder::Start(a_name);
+	}
+
+	inline bool StopRecording(RE::StaticFunctionTag*)
+	{
+		return Recorder::Stop();
 	}
 }
 
@@ -47,6 +118,16 @@ namespace PAR::Papyrus
 		REGISTERPAPYRUSFUNC(SetEnabled)
 		REGISTERPAPYRUSFUNC(Reload)
 		REGISTERPAPYRUSFUNC(Dump)
+		REGISTERPAPYRUSFUNC(DumpScene)
+		REGISTERPAPYRUSFUNC(StartBenchmark)
+		REGISTERPAPYRUSFUNC(BenchmarkLoader)
+		REGISTERPAPYRUSFUNC(BenchmarkPoseLookup)
+		REGISTERPAPYRUSFUNC(GetQualityLevel)
+		REGISTERPAPYRUSFUNC(LogStats)
+		REGISTERPAPYRUSFUNC(StartTrace)
+		REGISTERPAPYRUSFUNC(StopTrace)
+		REGISTERPAPYRUSFUNC(StartRecording)
+		REGISTERPAPYRUSFUNC(StopRecording)
 
 		return true;
 	}
@@ -0,0 +1,66 @@
+#include "Pose.h"
+
+using namespace PAR;
+
+void Pose::Begin(RE::NiAVObject* a_root)
+{
+	for (const auto bone : _touched) {
+		_index[bone] = UNRESOLVED;
+	}
+
+	_touched.clear();
+	_slots.clear();
+	_root = a_root;
+}
+
+RE::NiTransform* Pose::Get(BoneID a_bone)
+{
+	if (_index.size() <= a_bone) {
+		_index.resize(std::max<std::size_t>(BoneTable::Size(), a_bone + 1), UNRESOLVED);
+	}
+
+	auto& index = _index[a_bone];
+	if (index == MISSING)
+		return nullptr;
+
+	if (index != UNRESOLVED)
+		return std::addressof(_slots[index - 1].transform);
+
+	// the only scene graph lookup for this bone until the next Begin
+	_touched.push_back(a_bone);
+
+	const auto node = _root->GetObjectByName(BoneTable::GetFixedName(a_bone));
+	if (!node) {
+		index = MISSING;
+		return nullptr;
+	}
+
+	_slots.emplace_back(Slot{ a_bone, node, node->local });
+	index = static_cast<std::uint16_t>(_slots.size());
+
+	return std::addressof(_slots.back().transform);
+}
+
+void Pose::Commit()
+{
+	for (const auto& slot : _slots) {
+		slot.node->local = slot.transform;
+	}
+}
+
+void Pose::Capture(Snapshot& a_snapshot) const
+{
+	a_snapshot.clear();
+	for (const auto& slot : _slots) {
+		a_snapshot.emplace_back(slot.bone, slot.transform);
+	}
+}
+
+void Pose::Restore(const Snapshot& a_snapshot)
+{
+	for (const auto& [bone, transform] : a_snapshot) {
+		if (const auto slot = Get(bone)) {
+			*slot = transform;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "BoneTable.h"
+
+namespace PAR
+{
+	// Local transforms of the bones an actor's replacers touch, composed off the scene graph and written back once
+	class Pose
+	{
+	public:
+		void Begin(RE::NiAVObject* a_root);
+
+		// the transform of a_bone, starting from the node's current local, or nullptr if the actor has no such node
+		// only valid until the next call, slots may be reallocated
+		RE::NiTransform* Get(BoneID a_bone);
+
+		void Commit();
+
+		// the transforms of the last Commit, Restore writes them to another Begin
+		typedef std::vector<std::pair<BoneID, RE::NiTransform>> Snapshot;
+		void Capture(Snapshot& a_snapshot) const;
+		void Restore(const Snapshot& a_snapshot);
+
+	private:
+		struct Slot
+		{
+			BoneID bone;
+			RE::NiAVObject* node;
+			RE::NiTransform transform;
+		};
+
+		static constexpr std::uint16_t UNRESOLVED = 0;
+		static constexpr std::uint16_t MISSING = 0xFFFF;
+
+		RE::NiAVObject* _root = nullptr;
+
+		// bone id -> slot + 1, reset after every actor through _touched
+		std::vector<std::uint16_t> _index;
+		std::vector<BoneID> _touched;
+		std::vector<Slot> _slots;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "PoseIndex.h"
+
+#include <numeric>
+#include <xmmintrin.h>
+
+using namespace PAR;
+
+void PoseIndex::Describe(const RE::NiMatrix3& a_rotate, float* a_out)
+{
+	const auto& R = a_rotate.entry;
+	for (std::size_t i = 0; i < 3; ++i) {
+		a_out[i] = R[i][0];
+		a_out[3 + i] = R[i][1];
+	}
+}
+
+void PoseIndex::DescribeMissing(float* a_out)
+{
+	Describe(RE::NiMatrix3{}, a_out);
+}
+
+void PoseIndex::Build(const std::vector<FramePtr>& a_frames, const std::vector<BoneID>& a_keyBones)
+{
+	_dimensions = a_keyBones.size() * DIMENSIONS_PER_BONE;
+	_stride = (_dimensions + 3) & ~std::size_t{ 3 };
+	_descriptors.assign(a_frames.size() * _stride, 0.f);
+	_nodes.clear();
+	_root = -1;
+
+	if (a_frames.empty() || a_keyBones.empty())
+		return;
+
+	for (std::size_t frame = 0; frame < a_frames.size(); ++frame) {
+		auto descriptor = _descriptors.data() + frame * _stride;
+		for (std::size_t k = 0; k < a_keyBones.size(); ++k) {
+			const auto override = std::ranges::find(*a_frames[frame], a_keyBones[k], &Override::bone);
+			if (override != a_frames[frame]->end()) {
+				Describe(override->transform.rotate, descriptor + k * DIMENSIONS_PER_BONE);
+			} else {
+				DescribeMissing(descriptor + k * DIMENSIONS_PER_BONE);
+			}
+		}
+	}
+
+	std::vector<std::uint32_t> frames(a_frames.size());
+	std::iota(frames.begin(), frames.end(), 0u);
+
+	_nodes.reserve(frames.size());
+	_root = Split(frames, 0, frames.size());
+}
+
+// Splits on the dimension with the largest spread, the median frame becomes the node
+std::int32_t PoseIndex::Split(std::vector<std::uint32_t>& a_frames, std::size_t a_begin, std::size_t a_end)
+{
+	if (a_begin >= a_end)
+		return -1;
+
+	std::uint32_t axis = 0;
+	float spread = -1.f;
+	for (std::uint32_t d = 0; d < _dimensions; ++d) {
+		float lo = std::numeric_limits<float>::max();
+		float hi = std::numeric_limits<float>::lowest();
+		for (auto i = a_begin; i < a_end; ++i) {
+			const auto value = GetDescriptor(a_frames[i])[d];
+			lo = std::min(lo, value);
+			hi = std::max(hi, value);
+		}
+		if (hi - lo > spread) {
+			spread = hi - lo;
+			axis = d;
+		}
+	}
+
+	const auto mid = a_begin + (a_end - a_begin) / 2;
+	std::nth_element(a_frames.begin() + static_cast<std::ptrdiff_t>(a_begin), a_frames.begin() + static_cast<std::ptrdiff_t>(mid), a_frames.begin() + static_cast<std::ptrdiff_t>(a_end), [this, axis](auto a, auto b) {
+		return GetDescriptor(a)[axis] < GetDescriptor(b)[axis];
+	});
+
+	const auto node = static_cast<std::int32_t>(_nodes.size());
+	_nodes.push_back(Node{ a_frames[mid], axis });
+
+	const auto left = Split(a_frames, a_begin, mid);
+	const auto right = Split(a_frames, mid + 1, a_end);
+	_nodes[node].left = left;
+	_nodes[node].right = right;
+
+	return node;
+}
+
+float PoseIndex::Distance(const float* a_query, std::size_t a_frame) const
+{
+	const auto descriptor = GetDescriptor(a_frame);
+
+	auto sum = _mm_setzero_ps();
+	for (std::size_t i = 0; i < _stride; i += 4) {
+		const auto delta = _mm_sub_ps(_mm_loadu_ps(a_query + i), _mm_loadu_ps(descriptor + i));
+		sum = _mm_add_ps(sum, _mm_mul_ps(delta, delta));
+	}
+
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	return _mm_cvtss_f32(sum);
+}
+
+void PoseIndex::Search(std::int32_t a_node, const float* a_query, std::size_t& a_best, float& a_bestDistance) const
+{
+	if (a_node < 0)
+		return;
+
+	const auto& node = _nodes[a_node];
+
+	const auto distance = Distance(a_query, node.frame);
+	if (distance < a_bestDistance) {
+		a_bestDistance = distance;
+		a_best = node.frame;
+	}
+
+	const auto delta = a_query[node.axis] - GetDescriptor(node.frame)[node.axis];
+	const auto nearSide = delta < 0.f ? node.left : node.right;
+	const auto farSide = delta < 0.f ? node.right : node.left;
+
+	Search(nearSide, a_query, a_best, a_bestDistance);
+
+	// the other side can only hold a closer frame if the splitting plane is closer than the best so far
+	if (delta * delta < a_bestDistance) {
+		Search(farSide, a_query, a_best, a_bestDistance);
+	}
+}
+
+std::size_t PoseIndex::Nearest(const float* a_query) const
+{
+	std::size_t best = 0;
+	float bestDistance = std::numeric_limits<float>::max();
+	Search(_root, a_query, best, bestDistance);
+	return best;
+}
+
+std::size_t PoseIndex::NearestLinear(const float* a_query) const
+{
+	std::size_t best = 0;
+	float bestDistance = std::numeric_limits<float>::max();
+	for (std::size_t frame = 0; frame < _descriptors.size() / std::max<std::size_t>(_stride, 1); ++frame) {
+		if (const auto distance = Distance(a_query, frame); distance < bestDistance) {
+			bestDistance = distance;
+			best = frame;
+		}
+	}
+	return best;
+}
+
+std::size_t PoseIndex::GetSize() const
+{
+	return _descriptors.size() * sizeof(float) + _nodes.size() * sizeof(Node);
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "FramePool.h"
+
+namespace PAR
+{
+	// KD-tree over per-frame descriptors of a few key bones, finds the frame closest to a live pose
+	class PoseIndex
+	{
+	public:
+		// the bone's local x and y axes
+		static constexpr std::size_t DIMENSIONS_PER_BONE = 6;
+
+		void Build(const std::vector<FramePtr>& a_frames, const std::vector<BoneID>& a_keyBones);
+
+		// a_query holds GetStride() floats, Describe or DescribeMissing for each key bone followed by zeroed padding
+		std::size_t Nearest(const float* a_query) const;
+		std::size_t NearestLinear(const float* a_query) const;
+
+		static void Describe(const RE::NiMatrix3& a_rotate, float* a_out);
+		// stands in for a key bone the frame or the actor doesn't have, queries and frames must agree on it
+		static void DescribeMissing(float* a_out);
+
+		bool Empty() const { return _nodes.empty(); }
+		std::size_t GetDimensions() const { return _dimensions; }
+		std::size_t GetStride() const { return _stride; }
+		std::size_t GetSize() const;
+
+	private:
+		struct Node
+		{
+			std::uint32_t frame;
+			std::uint32_t axis;
+			std::int32_t left = -1;
+			std::int32_t right = -1;
+		};
+
+		std::int32_t Split(std::vector<std::uint32_t>& a_frames, std::size_t a_begin, std::size_t a_end);
+		void Search(std::int32_t a_node, const float* a_query, std::size_t& a_best, float& a_bestDistance) const;
+
+		float Distance(const float* a_query, std::size_t a_frame) const;
+		const float* GetDescriptor(std::size_t a_frame) const { return _descriptors.data() + a_frame * _stride; }
+
+		// frame-major, each row padded to a multiple of 4 floats
+		std::vector<float> _descriptors;
+		std::size_t _dimensions = 0;
+		std::size_t _stride = 0;
+
+		std::vector<Node> _nodes;
+		std::int32_t _root = -1;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include "Profiler.h"
+
+using namespace PAR;
+
+namespace
+{
+	std::uint64_t ToNanoseconds(std::chrono::nanoseconds a_cost)
+	{
+		return a_cost.count() > 0 ? static_cast<std::uint64_t>(a_cost.count()) : 0;
+	}
+
+	float ToMicroseconds(std::uint64_t a_ns)
+	{
+		return static_cast<float>(a_ns) / 1000.f;
+	}
+}
+
+void Profiler::Histogram::Add(std::uint64_t a_ns)
+{
+	const auto bucket = std::min<std::size_t>(std::bit_width(a_ns), NUM_BUCKETS - 1);
+	buckets[bucket] += 1;
+	count += 1;
+	totalNs += a_ns;
+	maxNs = std::max(maxNs, a_ns);
+}
+
+void Profiler::Histogram::Merge(const Histogram& a_other)
+{
+	for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+		buckets[i] += a_other.buckets[i];
+	}
+	count += a_other.count;
+	totalNs += a_other.totalNs;
+	maxNs = std::max(maxNs, a_other.maxNs);
+}
+
+// returns the upper bound of the bucket containing the percentile
+std::uint64_t Profiler::Histogram::Percentile(float a_pct) const
+{
+	if (count == 0)
+		return 0;
+
+	const auto target = static_cast<std::uint64_t>(a_pct * static_cast<float>(count));
+	std::uint64_t seen = 0;
+	for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+		seen += buckets[i];
+		if (seen > target) {
+			return std::min(maxNs, (std::uint64_t{ 1 } << i));
+		}
+	}
+
+	return maxNs;
+}
+
+void Profiler::ThreadBuffer::Merge(ThreadBuffer& a_other)
+{
+	std::unique_lock lock{ a_other.lock };
+
+	if (replacers.size() < a_other.replacers.size()) {
+		replacers.resize(a_other.replacers.size());
+	}
+
+	for (std::size_t i = 0; i < a_other.replacers.size(); ++i) {
+		const auto& src = a_other.replacers[i];
+		auto& dst = replacers[i];
+		dst.evaluations += src.evaluations;
+		dst.passes += src.passes;
+		dst.applies += src.applies;
+		dst.compositions += src.compositions;
+		dst.evalNs += src.evalNs;
+		dst.applyNs += src.applyNs;
+		dst.composeNs += src.composeNs;
+	}
+
+	for (std::size_t i = 0; i < phases.size(); ++i) {
+		phases[i].Merge(a_other.phases[i]);
+	}
+
+	cacheHits += a_other.cacheHits;
+	cacheMisses += a_other.cacheMisses;
+	poseGroups += a_other.poseGroups;
+	posedActors += a_other.posedActors;
+}
+
+void Profiler::ThreadBuffer::Clear()
+{
+	replacers.clear();
+	phases.fill(Histogram{});
+	cacheHits = 0;
+	cacheMisses = 0;
+	poseGroups = 0;
+	posedActors = 0;
+}
+
+Profiler::LocalBuffer::LocalBuffer() :
+	buffer(std::make_shared<ThreadBuffer>())
+{
+	auto& registry = GetRegistry();
+	std::unique_lock lock{ registry.lock };
+	registry.buffers.push_back(buffer);
+}
+
+Profiler::LocalBuffer::~LocalBuffer()
+{
+	// evaluation runs on short-lived threads, fold their counters into the retired buffer
+	auto& registry = GetRegistry();
+	std::unique_lock lock{ registry.lock };
+	registry.retired.Merge(*buffer);
+	std::erase(registry.buffers, buffer);
+}
+
+Profiler::Registry& Profiler::GetRegistry()
+{
+	// intentionally leaked, thread buffers may be destroyed after static destruction
+	static auto registry = new Registry();
+	return *registry;
+}
+
+Profiler::ThreadBuffer& Profiler::GetLocal()
+{
+	thread_local LocalBuffer local;
+	return *local.buffer;
+}
+
+std::uint32_t Profiler::RegisterReplacer(const std::string& a_name)
+{
+	auto& registry = GetRegistry();
+	std::unique_lock lock{ registry.lock };
+
+	if (const auto iter = registry.ids.find(a_name); iter != registry.ids.end()) {
+		return iter->second;
+	}
+
+	const auto id = static_cast<std::uint32_t>(registry.names.size());
+	registry.names.push_back(a_name);
+	registry.ids[a_name] = id;
+	return id;
+}
+
+void Profiler::RecordEvaluation(std::uint32_t a_id, bool a_passed, std::chrono::nanoseconds a_cost)
+{
+	auto& local = GetLocal();
+	std::unique_lock lock{ local.lock };
+
+	if (local.replacers.size() <= a_id) {
+		local.replacers.resize(a_id + 1);
+	}
+
+	auto& counters = local.replacers[a_id];
+	counters.evaluations += 1;
+	counters.passes += a_passed;
+	counters.evalNs += ToNanoseconds(a_cost);
+}
+
+void Profiler::RecordApply(std::uint32_t a_id, std::chrono::nanoseconds a_cost)
+{
+	auto& local = GetLocal();
+	std::unique_lock lock{ local.lock };
+
+	if (local.replacers.size() <= a_id) {
+		local.replacers.resize(a_id + 1);
+	}
+
+	auto& counters = local.replacers[a_id];
+	counters.applies += 1;
+	counters.applyNs += ToNanoseconds(a_cost);
+}
+
+void Profiler::RecordCompose(std::uint32_t a_id, std::chrono::nanoseconds a_cost)
+{
+	auto& local = GetLocal();
+	std::unique_lock lock{ local.lock };
+
+	if (local.replacers.size() <= a_id) {
+		local.replacers.resize(a_id + 1);
+	}
+
+	auto& counters = local.replacers[a_id];
+	counters.compositions += 1;
+	counters.composeNs += ToNanoseconds(a_cost);
+}
+
+void Profiler::RecordPhase(Phase a_phase, std::chrono::nanoseconds a_cost)
+{
+	auto& local = GetLocal();
+	std::unique_lock lock{ local.lock };
+	local.phases[std::to_underlying(a_phase)].Add(ToNanoseconds(a_cost));
+}
+
+void Profiler::RecordCacheLookup(bool a_hit)
+{
+	auto& local = GetLocal();
+	std::unique_lock lock{ local.lock };
+	(a_hit ? local.cacheHits : local.cacheMisses) += 1;
+}
+
+void Profiler::RecordInstancing(std::size_t a_groups, std::size_t a_actors)
+{
+	auto& local = GetLocal();
+	std::unique_lock lock{ local.lock };
+	local.poseGroups += a_groups;
+	local.posedActors += a_actors;
+}
+
+void Profiler::LogReport(bool a_reset)
+{
+	auto& registry = GetRegistry();
+	std::unique_lock lock{ registry.lock };
+
+	ThreadBuffer total;
+	total.Merge(registry.retired);
+	for (const auto& buffer : registry.buffers) {
+		total.Merge(*buffer);
+	}
+
+	logger::info("=== PartialAnimationReplacer stats ===");
+
+	for (std::size_t i = 0; i < total.phases.size(); ++i) {
+		const auto& hist = total.phases[i];
+		if (hist.count == 0)
+			continue;
+
+		logger::info("{}: {} calls, mean {:.1f}us, p50 <{:.1f}us, p99 <{:.1f}us, max {:.1f}us",
+			magic_enum::enum_name(static_cast<Phase>(i)),
+			hist.count,
+			ToMicroseconds(hist.totalNs / hist.count),
+			ToMicroseconds(hist.Percentile(0.5f)),
+			ToMicroseconds(hist.Percentile(0.99f)),
+			ToMicroseconds(hist.maxNs));
+	}
+
+	if (const auto lookups = total.cacheHits + total.cacheMisses) {
+		logger::info("selection cache: {} hits, {} misses ({:.1f}% hit ratio)",
+			total.cacheHits, total.cacheMisses, 100.f * static_cast<float>(total.cacheHits) / static_cast<float>(lookups));
+	}
+
+	if (total.poseGroups) {
+		logger::info("pose instancing: {} composed poses for {} actors ({:.2f} actors per pose)",
+			total.poseGroups, total.posedActors, static_cast<float>(total.posedActors) / static_cast<float>(total.poseGroups));
+	}
+
+	std::vector<std::uint32_t> order;
+	for (std::uint32_t id = 0; id < total.replacers.size(); ++id) {
+		if (total.replacers[id].evaluations || total.replacers[id].applies || total.replacers[id].compositions) {
+			order.push_back(id);
+		}
+	}
+
+	std::ranges::sort(order, [&total](auto a, auto b) {
+		const auto& ca = total.replacers[a];
+		const auto& cb = total.replacers[b];
+		return ca.evalNs + ca.applyNs + ca.composeNs > cb.evalNs + cb.applyNs + cb.composeNs;
+	});
+
+	for (const auto id : order) {
+		const auto& counters = total.replacers[id];
+		const auto passRate = counters.evaluations ? 100.f * static_cast<float>(counters.passes) / static_cast<float>(counters.evaluations) : 0.f;
+
+		logger::info("{}: {} evals ({:.1f}% pass) {:.1f}us, {} applies {:.1f}us, {} compositions {:.1f}us",
+			registry.names[id],
+			counters.evaluations,
+			passRate,
+			ToMicroseconds(counters.evalNs),
+			counters.applies,
+			ToMicroseconds(counters.applyNs),
+			counters.compositions,
+			ToMicroseconds(counters.composeNs));
+	}
+
+	if (a_reset) {
+		registry.retired.Clear();
+		for (const auto& buffer : registry.buffers) {
+			std::unique_lock bufferLock{ buffer->lock };
+			buffer->Clear();
+		}
+	}
+}
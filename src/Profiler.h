@@ -0,0 +1,114 @@
+#pragma once
+
+namespace PAR
+{
+	enum class Phase : std::uint32_t
+	{
+		kEvaluateReplacers,
+		kComposePoses,
+		kApplyReplacers,
+		kApplyLimits,
+		kMatchPose,
+		kCommitPose,
+		kNodeUpdate,
+		kDumperOnFrame,
+
+		kTotal
+	};
+
+	// Always-on counters, written to per-thread buffers and only aggregated when a report is requested
+	class Profiler
+	{
+	public:
+		using clock = std::chrono::steady_clock;
+
+		static constexpr std::size_t NUM_BUCKETS = 32;
+
+		struct ReplacerCounters
+		{
+			std::uint64_t evaluations = 0;
+			std::uint64_t passes = 0;
+			std::uint64_t applies = 0;
+			std::uint64_t compositions = 0;
+			std::uint64_t evalNs = 0;
+			std::uint64_t applyNs = 0;
+			std::uint64_t composeNs = 0;
+		};
+
+		// log2 buckets over nanoseconds
+		struct Histogram
+		{
+			std::array<std::uint64_t, NUM_BUCKETS> buckets{};
+			std::uint64_t count = 0;
+			std::uint64_t totalNs = 0;
+			std::uint64_t maxNs = 0;
+
+			void Add(std::uint64_t a_ns);
+			void Merge(const Histogram& a_other);
+			std::uint64_t Percentile(float a_pct) const;
+		};
+
+		class ScopedPhase
+		{
+		public:
+			explicit ScopedPhase(Phase a_phase) :
+				_phase(a_phase), _start(clock::now()) {}
+			~ScopedPhase() { RecordPhase(_phase, clock::now() - _start); }
+
+			ScopedPhase(const ScopedPhase&) = delete;
+			ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+		private:
+			Phase _phase;
+			clock::time_point _start;
+		};
+
+		static std::uint32_t RegisterReplacer(const std::string& a_name);
+
+		static void RecordEvaluation(std::uint32_t a_id, bool a_passed, std::chrono::nanoseconds a_cost);
+		// per frame and actor
+		static void RecordApply(std::uint32_t a_id, std::chrono::nanoseconds a_cost);
+		// per evaluation and pose group, the interpreted overrides and limits are applied from the composition after that
+		static void RecordCompose(std::uint32_t a_id, std::chrono::nanoseconds a_cost);
+		static void RecordPhase(Phase a_phase, std::chrono::nanoseconds a_cost);
+		static void RecordCacheLookup(bool a_hit);
+		static void RecordInstancing(std::size_t a_groups, std::size_t a_actors);
+
+		static void LogReport(bool a_reset);
+
+	private:
+		struct ThreadBuffer
+		{
+			std::mutex lock;
+			std::vector<ReplacerCounters> replacers;
+			std::array<Histogram, std::to_underlying(Phase::kTotal)> phases;
+			std::uint64_t cacheHits = 0;
+			std::uint64_t cacheMisses = 0;
+			std::uint64_t poseGroups = 0;
+			std::uint64_t posedActors = 0;
+
+			void Merge(ThreadBuffer& a_other);
+			void Clear();
+		};
+
+		struct Registry
+		{
+			std::mutex lock;
+			std::vector<std::string> names;
+			std::unordered_map<std::string, std::uint32_t> ids;
+			std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+			ThreadBuffer retired;
+		};
+
+		struct LocalBuffer
+		{
+			LocalBuffer();
+			~LocalBuffer();
+
+			std::shared_ptr<ThreadBuffer> buffer;
+		};
+
+		static Registry& GetRegistry();
+		static ThreadBuffer& GetLocal();
+	};
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace PAR
+{
+	// Replaces the value of a_slot with a_value only while a_isCurrent() holds, for results computed from a
+	// snapshot a writer may replace meanwhile. As long as the writer publishes its snapshot before it replaces
+	// the slot, either a_isCurrent() already sees the new snapshot, or the writer's replacement lands after this
+	template <class T, class Pred>
+	bool PublishIfCurrent(std::atomic<std::shared_ptr<T>>& a_slot, const std::shared_ptr<T>& a_value, Pred&& a_isCurrent)
+	{
+		auto expected = a_slot.load();
+		do {
+			if (!a_isCurrent())
+				return false;
+		} while (!a_slot.compare_exchange_weak(expected, a_value));
+
+		return true;
+	}
+
+	// A snapshot writers replace and the results evaluated from it, a result is only published while the snapshot
+	// it was evaluated from is still the current one
+	template <class Snapshot, class Result>
+	class Publication
+	{
+	public:
+		// stays alive as long as the caller holds it, also once it's replaced
+		std::shared_ptr<const Snapshot> Pin() const { return _snapshot.load(); }
+		std::shared_ptr<Result> Current() const { return _current.load(); }
+
+		// for writers, serialized by the caller: the snapshot is replaced first, so an evaluation of the old one
+		// either fails to publish or is overwritten by a_empty
+		void Replace(std::shared_ptr<const Snapshot> a_snapshot, std::shared_ptr<Result> a_empty)
+		{
+			_snapshot.store(std::move(a_snapshot));
+			_current.store(std::move(a_empty));
+		}
+
+		// false if a_pinned was replaced meanwhile, a pinned snapshot can't be freed and its address reused
+		bool Publish(const std::shared_ptr<const Snapshot>& a_pinned, const std::shared_ptr<Result>& a_result)
+		{
+			return PublishIfCurrent(_current, a_result, [&]() {
+				return _snapshot.load() == a_pinned;
+			});
+		}
+
+	private:
+		std::atomic<std::shared_ptr<const Snapshot>> _snapshot;
+		std::atomic<std::shared_ptr<Result>> _current;
+	};
+}
@@ -0,0 +1,186 @@
+#include "Recorder.h"
+#include "ReplacerManager.h"
+
+using namespace PAR;
+
+bool Recorder::Start(const std::string& a_name)
+{
+	auto path = logger::log_directory();
+	if (!path) {
+		return false;
+	}
+
+	*path /= a_name.ends_with(".parrec") ? a_name : a_name + ".parrec";
+
+	std::unique_lock lock{ _lock };
+
+	_file = std::ofstream{ *path, std::ios::binary | std::ios::trunc };
+	if (!_file.is_open()) {
+		logger::error("failed to open recording {}", path->string());
+		_recording = false;
+		return false;
+	}
+
+	std::vector<std::uint8_t> header;
+	Recording::Writer writer{ header };
+	writer.Put(Recording::MAGIC);
+	writer.Put(Recording::VERSION);
+	_file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+
+	// passes begun before this point belong to the previous session and are dropped
+	_session += 1;
+	_writtenVersion = 0;
+	_path = *path;
+	_recording = true;
+
+	logger::info("recording started to {}", _path.string());
+	return true;
+}
+
+bool Recorder::Stop()
+{
+	std::unique_lock lock{ _lock };
+
+	if (!_recording)
+		return false;
+
+	_recording = false;
+	_session += 1;
+	_file.close();
+
+	logger::info("recording stopped, wrote {}", _path.string());
+	return true;
+}
+
+void Recorder::BeginPass(const Generation& a_generation)
+{
+	if (!IsRecording())
+		return;
+
+	_pass.clear();
+	Recording::Writer writer{ _pass };
+
+	{
+		std::unique_lock lock{ _lock };
+		if (!_recording)
+			return;
+
+		_passSession = _session;
+
+		// each file is self-contained, the generation is written again after a restart
+		if (_writtenVersion != a_generation.version) {
+			WriteGeneration(a_generation, writer);
+			_writtenVersion = a_generation.version;
+		}
+	}
+
+	if (_indexedVersion != a_generation.version) {
+		_indices.clear();
+		for (std::uint32_t i = 0; i < a_generation.replacers.size(); ++i) {
+			_indices[a_generation.replacers[i].get()] = i;
+		}
+		_indexedVersion = a_generation.version;
+	}
+
+	writer.Put(Recording::Tag::kPass);
+	_passHeader = _pass.size();
+	writer.Put(std::uint64_t{ 0 });  // selection time, patched in EndPass
+	writer.Put(std::uint32_t{ 0 });  // actor count, patched in EndPass
+
+	_actors = 0;
+	_passActive = true;
+}
+
+void Recorder::EndPass(std::chrono::nanoseconds a_selection)
+{
+	if (!_passActive)
+		return;
+
+	_passActive = false;
+
+	const auto ns = static_cast<std::uint64_t>(std::max(a_selection.count(), 0ll));
+	std::memcpy(_pass.data() + _passHeader, &ns, sizeof(ns));
+	std::memcpy(_pass.data() + _passHeader + sizeof(ns), &_actors, sizeof(_actors));
+
+	std::unique_lock lock{ _lock };
+	if (!_recording || _passSession != _session)
+		return;
+
+	_file.write(reinterpret_cast<const char*>(_pass.data()), static_cast<std::streamsize>(_pass.size()));
+}
+
+void Recorder::BeginActor(RE::Actor* a_actor)
+{
+	if (!_passActive)
+		return;
+
+	const auto race = a_actor->GetRace();
+
+	Recording::Writer writer{ _pass };
+	writer.Put(a_actor->GetFormID());
+	writer.Put(race ? race->GetFormID() : RE::FormID{ 0 });
+
+	_outcomes.clear();
+}
+
+void Recorder::RecordOutcome(bool a_passed)
+{
+	if (_passActive) {
+		_outcomes.push_back(a_passed);
+	}
+}
+
+void Recorder::EndActor(bool a_cacheHit, const std::vector<std::shared_ptr<Replacer>>& a_selected)
+{
+	if (!_passActive)
+		return;
+
+	Recording::Writer writer{ _pass };
+	writer.Put(a_cacheHit ? Recording::kCacheHit : Recording::kNone);
+	writer.PutBits(_outcomes);
+
+	writer.Put(static_cast<std::uint16_t>(a_selected.size()));
+	for (const auto& replacer : a_selected) {
+		writer.Put(_indices.at(replacer.get()));
+	}
+
+	_actors += 1;
+}
+
+void Recorder::WriteGeneration(const Generation& a_generation, Recording::Writer& a_writer)
+{
+	a_writer.Put(Recording::Tag::kGeneration);
+	a_writer.Put(a_generation.version);
+
+	// bones are written by id, ids are stable for the whole session
+	a_writer.Put(static_cast<std::uint32_t>(a_generation.replacers.size()));
+	for (const auto& replacer : a_generation.replacers) {
+		a_writer.PutString(replacer->GetName());
+
+		std::vector<BoneID> bones;
+		for (BoneID bone = 0; bone < BoneTable::Size(); ++bone) {
+			if (replacer->GetBoneset().Contains(bone)) {
+				bones.push_back(bone);
+			}
+		}
+
+		a_writer.Put(static_cast<std::uint16_t>(bones.size()));
+		for (const auto bone : bones) {
+			a_writer.Put(bone);
+		}
+	}
+
+	a_writer.Put(static_cast<std::uint32_t>(a_generation.unindexed.size()));
+	for (const auto index : a_generation.unindexed) {
+		a_writer.Put(index);
+	}
+
+	a_writer.Put(static_cast<std::uint32_t>(a_generation.raceIndex.size()));
+	for (const auto& [race, indices] : a_generation.raceIndex) {
+		a_writer.Put(race);
+		a_writer.Put(static_cast<std::uint32_t>(indices.size()));
+		for (const auto index : indices) {
+			a_writer.Put(index);
+		}
+	}
+}
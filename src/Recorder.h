@@ -0,0 +1,48 @@
+#pragma once
+
+#include "RecordingFormat.h"
+
+namespace PAR
+{
+	class Replacer;
+	struct Generation;
+
+	// Opt-in capture of every evaluation pass, replayed offline by tools/SelectionReplay
+	// All pass functions run on the evaluation thread under ReplacerManager's _evalMutex and do nothing outside a pass
+	class Recorder
+	{
+	public:
+		static bool Start(const std::string& a_name);
+		static bool Stop();
+
+		static bool IsRecording() { return _recording.load(std::memory_order_relaxed); }
+
+		static void BeginPass(const Generation& a_generation);
+		static void EndPass(std::chrono::nanoseconds a_selection);
+
+		static void BeginActor(RE::Actor* a_actor);
+		static void RecordOutcome(bool a_passed);
+		static void EndActor(bool a_cacheHit, const std::vector<std::shared_ptr<Replacer>>& a_selected);
+
+	private:
+		static void WriteGeneration(const Generation& a_generation, Recording::Writer& a_writer);
+
+		// guards the file and the session, taken once per pass
+		static inline std::mutex _lock;
+		static inline std::ofstream _file;
+		static inline fs::path _path;
+		static inline std::uint32_t _session = 0;
+		static inline std::uint64_t _writtenVersion = 0;
+		static inline std::atomic<bool> _recording = false;
+
+		// state of the current pass, evaluation thread only
+		static inline bool _passActive = false;
+		static inline std::uint32_t _passSession = 0;
+		static inline std::vector<std::uint8_t> _pass;
+		static inline std::size_t _passHeader = 0;
+		static inline std::uint32_t _actors = 0;
+		static inline std::vector<bool> _outcomes;
+		static inline std::unordered_map<const Replacer*, std::uint32_t> _indices;
+		static inline std::uint64_t _indexedVersion = 0;
+	};
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Binary stream written by Recorder and read by tools/SelectionReplay, little endian
+//
+// header:     u32 magic, u32 version
+// generation: u8 tag, u64 version, u32 replacers { u16 length, name, u16 bones, u16 bone[] }
+//             u32 unindexed, u32 index[], u32 races { u32 race, u32 count, u32 index[] }
+// pass:       u8 tag, u64 selection ns, u32 actors { u32 actor, u32 race, u8 flags,
+//             u32 outcomes, u8 bits[(outcomes + 7) / 8], u16 selected, u32 index[] }
+//
+// a pass always refers to the last generation before it, outcomes are the results of the
+// prefilter and conditions of each replacer in the order selection asked for them
+
+namespace PAR::Recording
+{
+	constexpr std::uint32_t MAGIC = 0x52524150;  // "PARR"
+	constexpr std::uint32_t VERSION = 1;
+
+	enum class Tag : std::uint8_t
+	{
+		kGeneration = 1,
+		kPass = 2
+	};
+
+	enum ActorFlags : std::uint8_t
+	{
+		kNone = 0,
+		kCacheHit = 1 << 0  // selection was reused, no outcomes were recorded
+	};
+
+	class Writer
+	{
+	public:
+		explicit Writer(std::vector<std::uint8_t>& a_out) :
+			_out(a_out) {}
+
+		template <class T>
+		void Put(T a_value)
+		{
+			const auto size = _out.size();
+			_out.resize(size + sizeof(T));
+			std::memcpy(_out.data() + size, &a_value, sizeof(T));
+		}
+
+		void PutString(std::string_view a_value)
+		{
+			Put(static_cast<std::uint16_t>(a_value.size()));
+			_out.insert(_out.end(), a_value.begin(), a_value.end());
+		}
+
+		void PutBits(const std::vector<bool>& a_bits)
+		{
+			Put(static_cast<std::uint32_t>(a_bits.size()));
+			std::uint8_t byte = 0;
+			for (std::size_t i = 0; i < a_bits.size(); ++i) {
+				byte |= static_cast<std::uint8_t>(a_bits[i]) << (i % 8);
+				if (i % 8 == 7 || i + 1 == a_bits.size()) {
+					_out.push_back(byte);
+					byte = 0;
+				}
+			}
+		}
+
+	private:
+		std::vector<std::uint8_t>& _out;
+	};
+
+	// Reads past the end return zeroes and clear Ok()
+	class Reader
+	{
+	public:
+		Reader(const std::uint8_t* a_data, std::size_t a_size) :
+			_pos(a_data), _end(a_data + a_size) {}
+
+		template <class T>
+		T Get()
+		{
+			T value{};
+			if (Take(sizeof(T))) {
+				std::memcpy(&value, _pos - sizeof(T), sizeof(T));
+			}
+			return value;
+		}
+
+		std::string GetString()
+		{
+			const auto size = Get<std::uint16_t>();
+			return Take(size) ? std::string{ reinterpret_cast<const char*>(_pos - size), size } : std::string{};
+		}
+
+		void GetBits(std::vector<bool>& a_bits)
+		{
+			const auto count = Get<std::uint32_t>();
+			const auto bytes = (static_cast<std::size_t>(count) + 7) / 8;
+			a_bits.clear();
+			if (!Take(bytes))
+				return;
+
+			const auto data = _pos - bytes;
+			for (std::uint32_t i = 0; i < count; ++i) {
+				a_bits.push_back((data[i / 8] >> (i % 8)) & 1);
+			}
+		}
+
+		bool Ok() const { return _ok; }
+		bool AtEnd() const { return _pos == _end; }
+
+	private:
+		bool Take(std::size_t a_size)
+		{
+			if (!_ok || static_cast<std::size_t>(_end - _pos) < a_size) {
+				_ok = false;
+				return false;
+			}
+			_pos += a_size;
+			return true;
+		}
+
+		const std::uint8_t* _pos;
+		const std::uint8_t* _end;
+		bool _ok = true;
+	};
+}
@@ -1,150 +1,485 @@
 #include "Replacer.h"
+#include "ConditionArena.h"
+#include "Profiler.h"
+#include "Residency.h"
+#include "Fingerprint.h"
+#include "FastMath.h"
+#include "Kernel.h"
+#include "Settings.h"
+#include "ReplacerReader.h"
+#include "Mirror.h"
 
 namespace PAR
 {
-	Replacer::Replacer(const ReplacerData& a_raw) :
+	Replacer::Replacer(ReplacerData&& a_raw, const std::string& a_name) :
 		_priority(a_raw.priority),
-		_frames(a_raw.frames),
-		_limits(a_raw.limits),
 		_rotate(a_raw.rotate),
 		_translate(a_raw.translate),
-		_scale(a_raw.scale)
+		_scale(a_raw.scale),
+		_matchPose(a_raw.matchPose),
+		_keyBones(a_raw.keyBones),
+		_name(a_name),
+		_profilerId(Profiler::RegisterReplacer(a_name))
 	{
-		for (const auto& [key, ref] : a_raw.refs) {
+		_conditionTexts = std::move(a_raw.conditions);
+		_refTexts = std::move(a_raw.refs);
+		_errors = CheckStructure(a_raw);
+
+		if (not a_raw.frames.empty()) {
+			for (const auto& override : a_raw.frames[0]) {
+				_boneset.Insert(override.bone);
+			}
+		}
+
+		for (const auto& lim : a_raw.limits) {
+			_boneset.Insert(lim.bone);
+		}
+
+		if (a_raw.mirror) {
+			_mirrorSource = std::make_unique<MirrorSource>();
+			for (std::size_t i = 0; i < a_raw.frames.size(); ++i) {
+				for (const auto& override : a_raw.frames[i]) {
+					(i == 0 ? _mirrorSource->firstFrame : _mirrorSource->frames).push_back(override.bone);
+				}
+			}
+			_mirrorSource->limits = a_raw.limits;
+		}
+
+		// only conditions and bones stay resident until the replacer is first selected, the payload is read again then
+		if (Settings::bLazyLoad) {
+			_stamp = Stamp(a_name);
+			return;
+		}
+
+		// last, the frames and limits are moved out of a_raw
+		_payload = BuildPayload(std::move(a_raw));
+		PrepareKernels();
+	}
+
+	Replacer::Replacer(const std::shared_ptr<Replacer>& a_source) :
+		_priority(a_source->_priority),
+		_rotate(a_source->_rotate),
+		_translate(a_source->_translate),
+		_scale(a_source->_scale),
+		_matchPose(a_source->_matchPose),
+		_name(a_source->_name + std::string{ MIRROR_SUFFIX }),
+		_profilerId(Profiler::RegisterReplacer(_name)),
+		_source(a_source)
+	{
+		_errors = a_source->_errors;
+
+		const auto mirror = std::move(a_source->_mirrorSource);
+		if (!mirror)
+			return;
+
+		const auto map = [this](BoneID a_bone) {
+			if (_boneMap.size() <= a_bone) {
+				_boneMap.resize(a_bone + 1, BoneTable::INVALID_BONE);
+			}
+			if (_boneMap[a_bone] == BoneTable::INVALID_BONE) {
+				_boneMap[a_bone] = Mirror::GetBone(a_bone);
+			}
+			return _boneMap[a_bone];
+		};
+
+		for (const auto bone : mirror->firstFrame) {
+			_boneset.Insert(map(bone));
+		}
+
+		// every frame, pose matching can pick any of them
+		for (const auto bone : mirror->frames) {
+			map(bone);
+		}
+
+		for (const auto& lim : mirror->limits) {
+			_mirroredLimits.push_back(Mirror::Reflect(lim));
+			_boneset.Insert(_mirroredLimits.back().bone);
+		}
+
+		for (const auto bone : a_source->_keyBones) {
+			_keyBones.push_back(map(bone));
+		}
+
+		PrepareKernels();
+	}
+
+	Replacer::~Replacer() = default;
+
+	void Replacer::ResolveForms()
+	{
+		if (_source) {
+			_conditions = _source->_conditions;
+			_refs = _source->_refs;
+			_prefilter = _source->_prefilter;
+			_fingerprintFeatures = _source->_fingerprintFeatures;
+			return;
+		}
+
+		for (const auto& [key, ref] : _refTexts) {
 			_refs[key] = Util::GetFormFromString(ref);
 		}
 
-		auto condition = std::make_shared<RE::TESCondition>();
-		RE::TESConditionItem** head = std::addressof(condition->head);
-		int numConditions = 0;
-		for (auto& text : a_raw.conditions) {
-			if (text.empty())
+		_conditions = ConditionArena<RE::TESCondition, RE::TESConditionItem>::Build(_conditionTexts, [&](const std::string& a_text, RE::TESConditionItem& a_item) {
+			if (!ConditionParser::Parse(a_text, _refs, a_item)) {
+				logger::info("Aborting condition parsing"sv);
+				return false;
+			}
+			return true;
+		});
+
+		BuildPrefilter();
+		_fingerprintFeatures = Fingerprint::GetFeatures(_conditions.get());
+
+		_conditionTexts.clear();
+		_refTexts.clear();
+	}
+
+	const std::shared_ptr<Replacer>& Replacer::GetSource() const
+	{
+		return _source;
+	}
+
+	BoneID Replacer::MapBone(BoneID a_bone) const
+	{
+		return a_bone < _boneMap.size() && _boneMap[a_bone] != BoneTable::INVALID_BONE ? _boneMap[a_bone] : a_bone;
+	}
+
+	// turns an override of the payload into the one this view applies
+	void Replacer::MapOverride(BoneID& a_bone, RE::NiTransform& a_transform) const
+	{
+		if (_source) {
+			a_bone = MapBone(a_bone);
+			Mirror::Reflect(a_transform);
+		}
+	}
+
+	void Replacer::BuildKernel()
+	{
+		std::vector<PoseOverride> overrides;
+		std::vector<LiveLimit> limits;
+		if (!Compose(overrides, limits))
+			return;
+
+		const auto build = [this, &overrides](const std::vector<LiveLimit>& a_limits) {
+			auto kernel = Kernel::Build(overrides, a_limits);
+			if (kernel && Settings::bVerifyJitKernels && !Kernel::Verify(*kernel, *this, !a_limits.empty(), _name)) {
+				// falls back to the interpreter
+				kernel.reset();
+			}
+			return kernel;
+		};
+
+		_kernel = build(limits);
+		_overridesKernel = _kernel && !limits.empty() ? build({}) : nullptr;
+	}
+
+	void Replacer::PrepareKernels()
+	{
+		// kernels bake a single frame
+		if (!Settings::bJitKernels || _matchPose || !IsResident())
+			return;
+
+		std::call_once(_kernelsBuilt, &Replacer::BuildKernel, this);
+	}
+
+	const Kernel* Replacer::GetKernel(bool a_limits) const
+	{
+		return !a_limits && _overridesKernel ? _overridesKernel.get() : _kernel.get();
+	}
+
+	// An item can only be used as a requirement if it isn't part of an OR group and checks for true
+	bool IsRequirement(const RE::TESConditionItem* a_item, const RE::TESConditionItem* a_prev)
+	{
+		const auto& data = a_item->data;
+		if (data.flags.isOR || (a_prev && a_prev->data.flags.isOR))
+			return false;
+
+		if (data.flags.global || data.object != RE::CONDITIONITEMOBJECT::kSelf)
+			return false;
+
+		return (data.flags.opCode == RE::CONDITION_ITEM_DATA::OpCode::kEqualTo && data.comparisonValue.f == 1.f) ||
+		       (data.flags.opCode == RE::CONDITION_ITEM_DATA::OpCode::kNotEqualTo && data.comparisonValue.f == 0.f);
+	}
+
+	void Replacer::BuildPrefilter()
+	{
+		if (!_conditions)
+			return;
+
+		const RE::TESConditionItem* prev = nullptr;
+		for (auto item = _conditions->head; item; prev = item, item = item->next) {
+			if (!IsRequirement(item, prev))
 				continue;
 
-			if (auto conditionItem = ConditionParser::Parse(text, _refs)) {
-				*head = conditionItem;
-				head = std::addressof(conditionItem->next);
-				numConditions += 1;
-			} else {
-				logger::info("Aborting condition parsing"sv);
-				numConditions = 0;
+			const auto& function = item->data.functionData;
+			const auto param = function.params[0];
+
+			switch (function.function.get()) {
+			case RE::FUNCTION_DATA::FunctionID::kGetIsRace:
+				if (!_prefilter.race && param) {
+					_prefilter.race = static_cast<RE::TESForm*>(param)->As<RE::TESRace>();
+				}
+				break;
+			case RE::FUNCTION_DATA::FunctionID::kGetIsSex:
+				_prefilter.sex = static_cast<std::int32_t>(reinterpret_cast<std::intptr_t>(param));
+				break;
+			case RE::FUNCTION_DATA::FunctionID::kGetInFaction:
+				if (param) {
+					if (const auto faction = static_cast<RE::TESForm*>(param)->As<RE::TESFaction>()) {
+						_prefilter.factions.push_back(faction);
+					}
+				}
+				break;
+			default:
 				break;
 			}
 		}
+	}
 
-		_conditions = numConditions ? condition : nullptr;
+	bool Prefilter::Matches(RE::Actor* a_actor) const
+	{
+		if (sex >= 0) {
+			const auto base = a_actor->GetActorBase();
+			if (!base || static_cast<std::int32_t>(base->GetSex()) != sex)
+				return false;
+		}
 
-		if (not _frames.empty()) {
-			for (const auto& override : _frames[0]) {
-				_boneset.insert(override.name);
-			}
+		for (const auto faction : factions) {
+			if (!a_actor->IsInFaction(faction))
+				return false;
 		}
 
-		for (const auto& lim : _limits) {
-			_boneset.insert(lim.name);
+		return true;
+	}
+
+	std::shared_ptr<const Payload> Replacer::BuildPayload(ReplacerData&& a_raw)
+	{
+		auto payload = std::make_shared<Payload>();
+
+		payload->frames.reserve(a_raw.frames.size());
+		for (auto& frame : a_raw.frames) {
+			payload->frames.push_back(FramePool::Intern(std::move(frame)));
+		}
+		payload->limits = std::move(a_raw.limits);
+
+		if (a_raw.matchPose) {
+			payload->index.Build(payload->frames, a_raw.keyBones);
+		}
+
+		return payload;
+	}
+
+	std::size_t Payload::GetSize() const
+	{
+		std::size_t size = sizeof(Payload) + frames.size() * sizeof(FramePtr) + limits.size() * sizeof(Limit) + index.GetSize();
+		for (const auto& frame : frames) {
+			size += frame->size() * sizeof(Override);
 		}
+		return size;
 	}
 
 	ReplacerData Replacer::GetData()
 	{
-		return ReplacerData{ _priority, _frames, _limits, _rotate, _translate, _scale };
+		ReplacerData data{ _priority, {}, {}, _rotate, _translate, _scale };
+		data.matchPose = _matchPose;
+		data.keyBones = _keyBones;
+
+		if (const auto payload = GetPayload()) {
+			for (const auto& frame : payload->frames) {
+				auto& copy = data.frames.emplace_back(*frame);
+				for (auto& override : copy) {
+					MapOverride(override.bone, override.transform);
+				}
+			}
+			data.limits = _source ? _mirroredLimits : payload->limits;
+		}
+
+		return data;
+	}
+
+	bool Replacer::IsResident() const
+	{
+		return GetPayload() != nullptr;
+	}
+
+	// a mirrored view owns no payload, its source is accounted for instead
+	std::size_t Replacer::GetResidentSize() const
+	{
+		if (_source)
+			return 0;
+
+		const auto payload = _payload.load();
+		return payload ? payload->GetSize() : 0;
 	}
 
-	void MatToEulerYXZ(const RE::NiMatrix3& Rot, RE::NiPoint3& angles)
+	// Reloads the transform payload from the source file after it was evicted
+	bool Replacer::MakeResident()
 	{
-		// Uses extrinsic YXZ (Y applied first) Tait-Bryan angles
-		// or equivalently, intrinsic ZXY
+		if (IsResident())
+			return true;
+
+		if (_source)
+			return _source->MakeResident();
 
-		const auto& R = Rot.entry;
-		if (R[1][2] <= 0.99999f && R[1][2] >= -0.99999f) {
-			// Normal case
-			angles.x = std::asin(-R[1][2]);
-			angles.y = RE::NiFastATan2(R[0][2], R[2][2]);
-			angles.z = RE::NiFastATan2(R[1][0], R[1][1]);
-		} else if (R[1][2] < -0.99999f) {
-			// Gimbal lock: x = 90 degrees
-			angles.x = -RE::NI_HALF_PI;
-			angles.y = 0.0f;
-			angles.z = RE::NiFastATan2(R[0][1], R[0][0]);
-		} else {
-			// Gimbal lock: x = -90 degrees
-			angles.x = -RE::NI_HALF_PI;
-			angles.y = 0.0f;
-			angles.z = RE::NiFastATan2(-R[0][1], R[0][0]);
+		// refused once, the file has to be reloaded to register it again
+		if (_stale)
+			return false;
+
+		if (Stamp(_name) != _stamp) {
+			logger::error("{} changed on disk since it was loaded, reload it to use it again", _name);
+			_stale = true;
+			return false;
+		}
+
+		try {
+			std::ifstream f{ _name, std::ios::binary };
+			auto raw = ReplacerReader::Read(f);
+
+			_payload = BuildPayload(std::move(raw));
+			return true;
+		} catch (std::exception& e) {
+			logger::error("failed to reload payload of {} - {}", _name, e.what());
+			return false;
 		}
 	}
 
-	void EulerYXZToMat(RE::NiMatrix3& Rot, const RE::NiPoint3& angles)
+	// taken right after the file was read, a write in between isn't noticed
+	auto Replacer::Stamp(const std::string& a_file) -> FileStamp
 	{
-		auto& R = Rot.entry;
-		const float cx = std::cos(angles.x), sx = std::sin(angles.x);
-		const float cy = std::cos(angles.y), sy = std::sin(angles.y);
-		const float cz = std::cos(angles.z), sz = std::sin(angles.z);
+		std::error_code ec;
+		const auto size = fs::file_size(a_file, ec);
+		if (ec)
+			return {};
+
+		const auto writeTime = fs::last_write_time(a_file, ec);
+		if (ec)
+			return {};
 
-		R[0][0] = cy * cz + sx * sy * sz;
-		R[0][1] = cz * sx * sy - cy * sz;
-		R[0][2] = cx * sy;
+		return { size, static_cast<std::int64_t>(writeTime.time_since_epoch().count()) };
+	}
 
-		R[1][0] = cx * sz;
-		R[1][1] = cx * cz;
-		R[1][2] = -sx;
+	std::size_t Replacer::Evict()
+	{
+		if (_source)
+			return 0;
 
-		R[2][0] = cy * sx * sz - cz * sy;
-		R[2][1] = cy * cz * sx + sy * sz;
-		R[2][2] = cx * cy;
+		const auto payload = _payload.exchange(nullptr);
+		return payload ? payload->GetSize() : 0;
 	}
 
 	float Replacer::Saturate(float x, float lo, float hi)
 	{
-		if (lo >= hi)  // do nothing
-			return x;
-		const float s = (hi - lo) / 2;
-		const float m = (hi + lo) / 2;
-		return m + s * std::tanh((x - m) / s);
+		return TransformOps::Saturate(x, lo, hi);
 	}
 
-	void Replacer::Apply(RE::NiAVObject* a_obj) const
+	// Appends the overrides of the first frame with the limits on them already applied, they don't depend on the live pose
+	std::shared_ptr<const Payload> Replacer::Compose(std::vector<PoseOverride>& a_overrides, std::vector<LiveLimit>& a_limits) const
 	{
-		if (not _frames.empty()) {
-			const auto& overrides = _frames[0];
+		auto payload = GetPayload();
+		if (!payload)
+			return nullptr;
 
-			for (const auto& override : overrides) {
-				if (const auto node = a_obj->GetObjectByName(override.name)) {
-					if (_rotate) {
-						node->local.rotate = override.transform.rotate;
-					}
-					if (_translate) {
-						node->local.translate = override.transform.translate;
-					}
-					if (_scale) {
-						node->local.scale = override.transform.scale;
-					}
-				}
+		const auto channels = GetChannels();
+		const auto first = a_overrides.size();
+
+		if (not payload->frames.empty()) {
+			for (const auto& override : *payload->frames[0]) {
+				auto& composed = a_overrides.emplace_back(PoseOverride{ override.bone, override.transform, channels });
+				MapOverride(composed.bone, composed.transform);
 			}
 		}
 
-		for (const auto& lim : _limits) {
-			if (const auto node = a_obj->GetObjectByName(lim.name)) {
-				if (_rotate) {
-					RE::NiPoint3 eulers;
-					MatToEulerYXZ(node->local.rotate, eulers);
-					for (int i = 0; i < 3; ++i) {
-						eulers[i] = Saturate(eulers[i], lim.rotate_low[i], lim.rotate_high[i]);
-						EulerYXZToMat(node->local.rotate, eulers);
-					}
-				}
-				if (_translate) {
-					for (int i = 0; i < 3; ++i) {
-						node->local.translate[i] = Saturate(node->local.translate[i], lim.translate_low[i], lim.translate_high[i]);
-					}
-				}
-				if (_scale) {
-					node->local.scale = Saturate(node->local.scale, lim.scale_low, lim.scale_high);
+		for (const auto& lim : _source ? _mirroredLimits : payload->limits) {
+			const auto overridden = std::find_if(a_overrides.begin() + static_cast<std::ptrdiff_t>(first), a_overrides.end(), [&lim](const auto& a_override) {
+				return a_override.bone == lim.bone;
+			});
+
+			if (overridden != a_overrides.end()) {
+				ApplyLimit(overridden->transform, lim, channels);
+			} else {
+				a_limits.emplace_back(LiveLimit{ std::addressof(lim), channels });
+			}
+		}
+
+		return payload;
+	}
+
+	std::uint8_t Replacer::GetChannels() const
+	{
+		return (_rotate ? kRotate : 0) | (_translate ? kTranslate : 0) | (_scale ? kScale : 0);
+	}
+
+	bool Replacer::MatchesPose() const
+	{
+		return _matchPose;
+	}
+
+	std::shared_ptr<const Payload> Replacer::GetPayload() const
+	{
+		return _source ? _source->GetPayload() : _payload.load();
+	}
+
+	void Replacer::DescribePose(const Payload& a_payload, Pose& a_pose, std::vector<float>& a_query) const
+	{
+		// always takes the stride, ApplyMatched steps through the queries by it
+		const auto& index = a_payload.index;
+		const auto offset = a_query.size();
+		a_query.resize(offset + index.GetStride(), 0.f);
+		if (index.Empty())
+			return;
+
+		for (std::size_t k = 0; k < _keyBones.size(); ++k) {
+			const auto descriptor = a_query.data() + offset + k * PoseIndex::DIMENSIONS_PER_BONE;
+			if (const auto transform = a_pose.Get(_keyBones[k])) {
+				// the index describes the source's side
+				auto rotate = transform->rotate;
+				if (_source) {
+					Mirror::Reflect(rotate);
 				}
+				PoseIndex::Describe(rotate, descriptor);
+			} else {
+				PoseIndex::DescribeMissing(descriptor);
 			}
 		}
 	}
 
+	// Runs every frame, the chosen frame depends on the animated pose of the key bones described in a_query
+	void Replacer::ApplyMatched(const Payload& a_payload, Pose& a_pose, const float* a_query, bool a_limits) const
+	{
+		const auto& index = a_payload.index;
+		if (index.Empty())
+			return;
+
+		const auto channels = GetChannels();
+		for (const auto& override : *a_payload.frames[index.Nearest(a_query)]) {
+			PoseOverride mapped{ override.bone, override.transform, channels };
+			MapOverride(mapped.bone, mapped.transform);
+
+			if (const auto transform = a_pose.Get(mapped.bone)) {
+				ApplyOverride(*transform, mapped);
+			}
+		}
+
+		if (!a_limits)
+			return;
+
+		for (const auto& lim : _source ? _mirroredLimits : a_payload.limits) {
+			if (const auto transform = a_pose.Get(lim.bone)) {
+				ApplyLimit(*transform, lim, channels);
+			}
+		}
+	}
+
+	void Replacer::ApplyOverride(RE::NiTransform& a_transform, const PoseOverride& a_override)
+	{
+		TransformOps::ApplyOverride(a_transform, a_override);
+	}
+
+	void Replacer::ApplyLimit(RE::NiTransform& a_transform, const Limit& a_limit, std::uint8_t a_channels)
+	{
+		TransformOps::ApplyLimit(a_transform, a_limit, a_channels);
+	}
+
 	bool Replacer::Eval(RE::Actor* a_actor) const
 	{
 		return _conditions != nullptr && _conditions->IsTrue(a_actor, a_actor);
@@ -158,35 +493,51 @@ namespace PAR
 			logger::error("{}: must have conditions", a_file);
 		}
 
-		if (_frames.empty() && _limits.empty()) {
-			logger::error("{}: no frames nor limits found", a_file);
+		if (_matchPose && (_keyBones.empty() || std::ranges::count(_keyBones, BoneTable::INVALID_BONE))) {
+			logger::error("{}: match_pose needs named key_bones", a_file);
+			valid = false;
+		}
+
+		for (const auto& error : _errors) {
+			logger::error("{}: {}", a_file, error);
 			valid = false;
 		}
 
-		for (int i = 0; i < _frames.size(); i++) {
-			const auto& frame = _frames[i];
+		return valid;
+	}
+
+	std::vector<std::string> Replacer::CheckStructure(const ReplacerData& a_raw)
+	{
+		std::vector<std::string> errors;
+
+		const auto& frames = a_raw.frames;
+		const auto& limits = a_raw.limits;
+
+		if (frames.empty() && limits.empty()) {
+			errors.emplace_back("no frames nor limits found");
+		}
+
+		for (std::size_t i = 0; i < frames.size(); i++) {
+			const auto& frame = frames[i];
 			if (frame.empty()) {
-				logger::error("{}: no overrides defined in frame at {}", a_file, i);
-				valid = false;
+				errors.push_back(std::format("no overrides defined in frame at {}", i));
 			}
 			for (const auto& override : frame) {
-				if (override.name.empty()) {
-					logger::error("{}: override with no node found in frame at {}", a_file, i);
-					valid = false;
+				if (override.bone == BoneTable::INVALID_BONE) {
+					errors.push_back(std::format("override with no node found in frame at {}", i));
 					break;
 				}
 			}
 		}
 
-		for (const auto& lim : _limits) {
-			if (lim.name.empty()) {
-				logger::error("{}: lim with no node found", a_file);
-				valid = false;
+		for (const auto& lim : limits) {
+			if (lim.bone == BoneTable::INVALID_BONE) {
+				errors.emplace_back("lim with no node found");
 				break;
 			}
 		}
 
-		return valid;
+		return errors;
 	}
 
 	uint64_t Replacer::GetPriority() const
@@ -199,10 +550,30 @@ namespace PAR
 		return _boneset;
 	}
 
+	const Prefilter& Replacer::GetPrefilter() const
+	{
+		return _prefilter;
+	}
+
+	std::uint32_t Replacer::GetFingerprintFeatures() const
+	{
+		return _fingerprintFeatures;
+	}
+
+	const std::string& Replacer::GetName() const
+	{
+		return _name;
+	}
+
+	std::uint32_t Replacer::GetProfilerId() const
+	{
+		return _profilerId;
+	}
+
 	// JSON helpers
 	void from_json(const json& j, Override& o)
 	{
-		o.name = j.value("name", "");
+		o.bone = BoneTable::Intern(j.value("name", ""));
 		const auto val = j.value("rotate", std::vector<std::vector<float>>{});
 
 		for (int i = 0; i < 3; i++) {
@@ -223,7 +594,7 @@ namespace PAR
 	void to_json(json& j, const Override& o)
 	{
 		j = json{
-			{ "name", o.name },
+			{ "name", BoneTable::GetName(o.bone) },
 			{ "rotate", o.transform.rotate.entry },
 			{ "translate",
 				json{
@@ -238,7 +609,7 @@ namespace PAR
 	void from_json(const json& j, Limit& c)
 	{
 		constexpr std::array<float, 3> zeros = std::array<float, 3>{ 0.f, 0.f, 0.f };
-		c.name = j.value("name", "");
+		c.bone = BoneTable::Intern(j.value("name", ""));
 		c.rotate_low = j.value("rotate_low", zeros);
 		c.rotate_high = j.value("rotate_high", zeros);
 		c.translate_low = j.value("translate_low", zeros);
@@ -264,7 +635,7 @@ namespace PAR
 		}
 
 		j = json{
-			{ "name", c.name },
+			{ "name", BoneTable::GetName(c.bone) },
 			{ "rotate_low", rotate_low_deg },
 			{ "rotate_high", rotate_high_deg },
 			{ "translate_low", c.translate_low },
@@ -284,6 +655,13 @@ namespace PAR
 		r.rotate = j.value("rotate", true);
 		r.translate = j.value("translate", false);
 		r.scale = j.value("scale", false);
+		r.matchPose = j.value("match_pose", false);
+		r.mirror = j.value("mirror", false);
+
+		r.keyBones.clear();
+		for (const auto& name : j.value("key_bones", std::vector<std::string>{})) {
+			r.keyBones.push_back(BoneTable::Intern(name));
+		}
 	}
 
 	void to_json(json& j, const ReplacerData& r)
@@ -298,5 +676,19 @@ namespace PAR
 			{ "frames", r.frames },
 			{ "limits", r.limits }
 		};
+
+		if (r.mirror) {
+			j["mirror"] = true;
+		}
+
+		if (r.matchPose) {
+			std::vector<std::string> keyBones;
+			for (const auto bone : r.keyBones) {
+				keyBones.push_back(BoneTable::GetName(bone));
+			}
+
+			j["match_pose"] = true;
+			j["key_bones"] = std::move(keyBones);
+		}
 	}
 }
@@ -1,21 +1,16 @@
 #pragma once
 
 #include "ConditionParser.h"
+#include "FramePool.h"
+#include "Pose.h"
+#include "PoseIndex.h"
+#include "TransformOps.h"
 
 namespace PAR
 {
-    struct Override
-    {
-        std::string name;
-        RE::NiTransform transform;
-    };
-
-    typedef std::vector<Override> Frame;
-    typedef std::set<std::reference_wrapper<const std::string>, std::less<std::string>> BoneSet;
-
     struct Limit
     {
-        std::string name;
+        BoneID bone;
         std::array<float, 3> rotate_low;   
         std::array<float, 3> rotate_high;  
         std::array<float, 3> translate_low;
@@ -36,35 +31,174 @@ namespace PAR
 
         std::vector<std::string> conditions;
         std::unordered_map<std::string, std::string> refs;
+
+        // picks the frame closest to the live pose of the key bones instead of the first one
+        bool matchPose = false;
+        std::vector<BoneID> keyBones;
+
+        // also registers the left/right reflection of this replacer
+        bool mirror = false;
+    };
+
+    // Cheap static requirements extracted from standalone AND-ed condition items
+    struct Prefilter
+    {
+        RE::TESRace* race = nullptr;
+        std::int32_t sex = -1;
+        std::vector<RE::TESFaction*> factions;
+
+        bool Matches(RE::Actor* a_actor) const;
+    };
+
+    // Transform data that can be evicted and reloaded on demand
+    struct Payload
+    {
+        std::vector<FramePtr> frames;
+        std::vector<Limit> limits;
+
+        // only built for replacers matching the pose
+        PoseIndex index;
+
+        std::size_t GetSize() const;
+    };
+
+    // Override restricted to the channels its replacer sets
+    struct PoseOverride
+    {
+        BoneID bone;
+        RE::NiTransform transform;
+        std::uint8_t channels;
+    };
+
+    // Limit on a bone without an override, it can only be applied to the live transform
+    struct LiveLimit
+    {
+        const Limit* limit;
+        std::uint8_t channels;
     };
 
+    class Kernel;
+
     class Replacer
     {
     public:
-        Replacer(const ReplacerData& a_raw);
+        static constexpr auto MIRROR_SUFFIX = " (mirrored)"sv;
+
+        Replacer(ReplacerData&& a_raw, const std::string& a_name);
+        // mirrored view of a_source, sharing its payload, built right after it from the bones and limits it kept
+        explicit Replacer(const std::shared_ptr<Replacer>& a_source);
+        ~Replacer();
+
+        // both constructors are free of form lookups and may run on any thread, this does them on the main thread
+        // a mirrored view takes the resolved conditions of its source, which must be resolved first
+        void ResolveForms();
 
         ReplacerData GetData();
         static float FastTanh(float x);
         static float Saturate(float x, float lo, float hi);
 
-        void Apply(RE::NiAVObject* a_obj) const;
+        // appends the index's query for the key bones of a_pose, to be taken before anything overrides them
+        void DescribePose(const Payload& a_payload, Pose& a_pose, std::vector<float>& a_query) const;
+        void ApplyMatched(const Payload& a_payload, Pose& a_pose, const float* a_query, bool a_limits) const;
+        std::shared_ptr<const Payload> Compose(std::vector<PoseOverride>& a_overrides, std::vector<LiveLimit>& a_limits) const;
+        static void ApplyOverride(RE::NiTransform& a_transform, const PoseOverride& a_override);
+        static void ApplyLimit(RE::NiTransform& a_transform, const Limit& a_limit, std::uint8_t a_channels);
+        // bakes the kernels the first time it's called with the payload resident, they stay valid while it's evicted
+        void PrepareKernels();
+        // without a_limits the kernel leaves the live limits out, same kernel if the replacer has none
+        const Kernel* GetKernel(bool a_limits) const;
         bool Eval(RE::Actor* a_actor) const;
         bool IsValid(const std::string& a_file) const;
+        bool MatchesPose() const;
+        std::shared_ptr<const Payload> GetPayload() const;
+        const std::shared_ptr<Replacer>& GetSource() const;
         uint64_t GetPriority() const;
         const BoneSet& GetBoneset() const;
+        const Prefilter& GetPrefilter() const;
+        std::uint32_t GetFingerprintFeatures() const;
+        const std::string& GetName() const;
+        std::uint32_t GetProfilerId() const;
+
+        bool IsResident() const;
+        std::size_t GetResidentSize() const;
+        bool MakeResident();
+        std::size_t Evict();
+
+        // set once the replacer left the generation, an evaluation still pinning the old one can't make it resident again
+        // only touched by Residency with its mutex held
+        void Retire() { _retired = true; }
+        bool IsRetired() const { return _retired; }
 
     private:
+        static std::shared_ptr<const Payload> BuildPayload(ReplacerData&& a_raw);
+        static std::vector<std::string> CheckStructure(const ReplacerData& a_raw);
+        void BuildPrefilter();
+        void BuildKernel();
+        std::uint8_t GetChannels() const;
+        BoneID MapBone(BoneID a_bone) const;
+        void MapOverride(BoneID& a_bone, RE::NiTransform& a_transform) const;
+
         uint64_t _priority;
-        std::vector<std::vector<Override>> _frames;
-        std::vector<Limit> _limits;
+        std::atomic<std::shared_ptr<const Payload>> _payload;
 
         bool _rotate;
         bool _translate;
         bool _scale;
 
+        bool _matchPose;
+        std::vector<BoneID> _keyBones;
+
+        // as read from the file, only kept until ResolveForms
+        std::vector<std::string> _conditionTexts;
+        std::unordered_map<std::string, std::string> _refTexts;
+
         std::shared_ptr<RE::TESCondition> _conditions;
         ConditionParser::RefMap _refs;
         BoneSet _boneset;
+        Prefilter _prefilter;
+        std::uint32_t _fingerprintFeatures = 0;
+
+        std::string _name;
+        std::uint32_t _profilerId;
+
+        // problems of the frames and limits, found while they were read so IsValid doesn't need the payload
+        std::vector<std::string> _errors;
+
+        // the file the replacer was registered from, in lazy load mode a payload re-read from a changed file is refused
+        // since the conditions, prefilter and boneset were built from the old one
+        struct FileStamp
+        {
+            std::uintmax_t size = 0;
+            std::int64_t writeTime = 0;
+
+            bool operator==(const FileStamp&) const = default;
+        };
+
+        static FileStamp Stamp(const std::string& a_file);
+
+        FileStamp _stamp;
+        bool _stale = false;
+        bool _retired = false;
+
+        // built from the payload once it's first resident, stays valid while the payload is evicted
+        std::once_flag _kernelsBuilt;
+        std::unique_ptr<Kernel> _kernel;
+        std::unique_ptr<Kernel> _overridesKernel;
+
+        // set on mirrored views, the payload is the source's and is read through the bone map and a reflection
+        std::shared_ptr<Replacer> _source;
+        std::vector<BoneID> _boneMap;
+        std::vector<Limit> _mirroredLimits;
+
+        // what a mirrored view is built from, kept by its source from the file until the view took it
+        struct MirrorSource
+        {
+            std::vector<BoneID> firstFrame;
+            std::vector<BoneID> frames;
+            std::vector<Limit> limits;
+        };
+
+        std::unique_ptr<MirrorSource> _mirrorSource;
     };
 
     void from_json(const json& j, Override& o);
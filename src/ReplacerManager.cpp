@@ -1,12 +1,33 @@
 #include "ReplacerManager.h"
+#include "Benchmark.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "Residency.h"
+#include "Settings.h"
+#include "Fingerprint.h"
+#include "ReplacerReader.h"
+#include "StatsExport.h"
+#include "Recorder.h"
+#include "Selection.h"
 
 using namespace PAR;
 
 void ReplacerManager::EvaluateReplacers()
 {
+	Profiler::ScopedPhase phase{ Phase::kEvaluateReplacers };
+	TRACE_SCOPE("EvaluateReplacers");
+
+	const auto start = std::chrono::steady_clock::now();
 	auto replacers = std::make_shared<ReplacerMap>();
 
-	std::unique_lock lock{ _mutex };
+	std::unique_lock lock{ _evalMutex, std::defer_lock };
+	{
+		TRACE_SCOPE("ReplacerManager::_evalMutex wait");
+		lock.lock();
+	}
+
+	// pinned for the whole pass, a concurrent reload publishes a new generation instead of waiting
+	const auto generation = _publication.Pin();
 
 	std::vector<RE::Actor*> actors{ RE::PlayerCharacter::GetSingleton() };
 	RE::ProcessLists::GetSingleton()->ForEachHighActor([&actors](RE::Actor* a_actor) {
@@ -17,62 +38,226 @@ void ReplacerManager::EvaluateReplacers()
 		return RE::BSContainer::ForEachResult::kContinue;
 	});
 
+	_passHits = 0;
+	_passMisses = 0;
+
+	// payloads touched from here on stay resident until Compose pinned them
+	if (Settings::bLazyLoad) {
+		Residency::BeginPass();
+	}
+
+	// safety valve for state the fingerprint doesn't capture, cached selections may also reference replaced files
+	if (_passes++ % Settings::uFullEvaluationInterval == 0 || _cacheVersion != generation->version) {
+		_cache.clear();
+		_cacheVersion = generation->version;
+	}
+
+	// identical selections are composed once, keyed by the selected replacers in order
+	std::map<std::vector<const Replacer*>, std::shared_ptr<ComposedPose>> groups;
+	std::vector<const Replacer*> key;
+
+	Recorder::BeginPass(*generation);
+	Profiler::clock::duration selection{};
+
 	for (const auto& actor : actors) {
-		FindReplacersForActor(actor, *replacers);
+		std::vector<std::shared_ptr<Replacer>> selected;
+
+		const auto selectionStart = Profiler::clock::now();
+		FindReplacersForActor(*generation, actor, selected);
+		selection += Profiler::clock::now() - selectionStart;
+
+		if (selected.empty())
+			continue;
+
+		key.clear();
+		for (const auto& replacer : selected) {
+			key.push_back(replacer.get());
+		}
+
+		auto& group = groups[key];
+		if (!group) {
+			group = std::make_shared<ComposedPose>();
+			group->replacers = std::move(selected);
+		}
+
+		(*replacers)[actor->GetFormID()] = group;
+	}
+
+	Recorder::EndPass(selection);
+
+	// drop actors that were not part of this pass
+	_cache.swap(_nextCache);
+	_nextCache.clear();
+
+	{
+		// static work taken off the frame, the hook only copies the result and runs limits on live bones
+		Profiler::ScopedPhase compose{ Phase::kComposePoses };
+		for (const auto& pose : groups | std::views::values) {
+			Compose(*pose);
+		}
+	}
+
+	Profiler::RecordInstancing(groups.size(), replacers->size());
+
+	if (StatsExport::IsOpen()) {
+		std::unordered_set<const Replacer*> active;
+		for (const auto& members : groups | std::views::keys) {
+			active.insert(members.begin(), members.end());
+		}
+
+		StatsExport::RecordEvaluation(std::chrono::steady_clock::now() - start,
+			static_cast<std::uint32_t>(actors.size()),
+			static_cast<std::uint32_t>(replacers->size()),
+			static_cast<std::uint32_t>(groups.size()),
+			static_cast<std::uint32_t>(generation->replacers.size()),
+			static_cast<std::uint32_t>(active.size()),
+			_passHits,
+			_passMisses);
 	}
 	
-	replacers = _current.exchange(replacers);
+	// a reload published a new generation during the pass, its selections may reference replaced files
+	const bool current = _publication.Publish(generation, replacers);
+
+	if (!current) {
+		logger::info("dropped the selections of generation {}, it was replaced while they were evaluated", generation->version);
+	}
+
+	if (Benchmark::IsRunning()) {
+		Benchmark::RecordEvaluation(std::chrono::steady_clock::now() - start);
+	}
 }
 
-// Helper function to test for common bones
-// The point is: no std::string copy, linear time
-bool HaveCommonElements(
-    const BoneSet& set1,
-    const BoneSet& set2)
+// Evaluates conditions on actor `a_actor` and appends applicable replacers to `a_selected`
+void ReplacerManager::FindReplacersForActor(const Generation& a_generation, RE::Actor* a_actor, std::vector<std::shared_ptr<Replacer>>& a_selected)
 {
-    auto it1 = set1.begin();
-    auto it2 = set2.begin();
-	// take advantage of std::sets being sorted structures
-    while (it1 != set1.end() && it2 != set2.end()) {
-        const std::string& s1 = it1->get();
-        const std::string& s2 = it2->get();
-        if (s1 == s2)
-            return true;
-        if (s1 < s2)
-            ++it1;
-        else
-            ++it2;
-    }
-    return false;
+	// logger::info("FindReplacersForActor on actor {:x} ({} candidates)", a_actor->formID, a_generation.replacers.size());
+	const auto id = a_actor->GetFormID();
+	const auto race = a_actor->GetRace();
+	const auto raceFeatures = race ? a_generation.raceFeatures.find(race->GetFormID()) : a_generation.raceFeatures.end();
+	const auto features = raceFeatures != a_generation.raceFeatures.end() ? raceFeatures->second : a_generation.unindexedFeatures;
+	const bool cacheable = Settings::bCacheSelections && !(features & Fingerprint::kUncacheable);
+	const auto fingerprint = cacheable ? Fingerprint::Compute(a_actor, features) : 0;
+
+	Recorder::BeginActor(a_actor);
+
+	if (cacheable) {
+		const auto iter = _cache.find(id);
+		const bool hit = iter != _cache.end() && iter->second.fingerprint == fingerprint;
+		Profiler::RecordCacheLookup(hit);
+		(hit ? _passHits : _passMisses) += 1;
+
+		if (hit) {
+			auto& selection = _nextCache[id] = std::move(iter->second);
+			if (Settings::bLazyLoad) {
+				for (const auto& replacer : selection.replacers) {
+					Residency::Touch(replacer);
+				}
+			}
+			a_selected = selection.replacers;
+			Recorder::EndActor(true, a_selected);
+			return;
+		}
+	}
+
+	std::vector<std::uint32_t> candidates;
+	GetCandidates(a_generation, a_actor, candidates);
+
+	std::size_t evaluated = 0;
+
+	const auto& replacers = a_generation.replacers;
+
+	// candidates are already sorted by decreasing priority
+	Selection::Select(
+		candidates,
+		a_generation.suffixCoverage,
+		[&](std::uint32_t a_index) -> const BoneSet& {
+			return replacers[a_index]->GetBoneset();
+		},
+		[&](std::uint32_t a_index) {
+			const auto& replacer = replacers[a_index];
+			if (!replacer->GetPrefilter().Matches(a_actor)) {
+				Recorder::RecordOutcome(false);
+				return false;
+			}
+
+			const auto start = Profiler::clock::now();
+			const bool passed = replacer->Eval(a_actor);
+			Profiler::RecordEvaluation(replacer->GetProfilerId(), passed, Profiler::clock::now() - start);
+			Recorder::RecordOutcome(passed);
+			evaluated += 1;
+
+			return passed;
+		},
+		[&](std::uint32_t a_index) {
+			const auto& replacer = replacers[a_index];
+			if (Settings::bLazyLoad) {
+				Residency::Touch(replacer);
+			}
+			a_selected.push_back(replacer);
+		});
+
+	Recorder::EndActor(false, a_selected);
+
+	if (cacheable) {
+		_nextCache[id] = CachedSelection{ fingerprint, a_selected };
+	}
+
+	if (Benchmark::IsRunning()) {
+		Benchmark::RecordCandidates(candidates.size(), evaluated, a_generation.replacers.size());
+	}
 }
 
-// Evaluates conditions on actor `a_actor` and inserts applicable replacers in `a_map`
-void ReplacerManager::FindReplacersForActor(RE::Actor* a_actor, ReplacerMap& a_map)
+void ReplacerManager::Compose(ComposedPose& a_pose)
 {
-	// logger::info("FindReplacersForActor on actor {:x} ({} candidates)", a_actor->formID, _replacers.size());
-	BoneSet replaced_bones;
-	// replacers are already sorted by decreasing priority
-	for (const auto& replacer : _replacers) {
-		if (replacer->Eval(a_actor)) {
-			// test for no shared bones
-			const BoneSet& incoming_bones = replacer->GetBoneset();
-			if (not HaveCommonElements(replaced_bones, incoming_bones)) {
-				a_map[a_actor->GetFormID()].push_back(replacer);
-				replaced_bones.insert(incoming_bones.begin(), incoming_bones.end());
+	for (const auto& replacer : a_pose.replacers) {
+		// selected replacers were made resident, a lazily loaded one bakes its kernels with its first selection
+		replacer->PrepareKernels();
+		if (const auto kernel = replacer->GetKernel(true)) {
+			a_pose.kernels.push_back({ kernel, replacer->GetKernel(false), replacer->GetProfilerId() });
+			continue;
+		}
+
+		if (replacer->MatchesPose()) {
+			if (auto payload = replacer->GetPayload()) {
+				a_pose.matched.emplace_back(replacer.get(), std::move(payload));
 			}
+			continue;
+		}
+
+		const auto start = Profiler::clock::now();
+		if (auto payload = replacer->Compose(a_pose.overrides, a_pose.limits)) {
+			a_pose.payloads.push_back(std::move(payload));
 		}
+		Profiler::RecordCompose(replacer->GetProfilerId(), Profiler::clock::now() - start);
 	}
 }
 
+// Merges the replacers without a race requirement with those requiring the actor's race
+void ReplacerManager::GetCandidates(const Generation& a_generation, RE::Actor* a_actor, std::vector<std::uint32_t>& a_candidates)
+{
+	const auto& raceIndex = a_generation.raceIndex;
+	const auto race = a_actor->GetRace();
+	const auto iter = race ? raceIndex.find(race->GetFormID()) : raceIndex.end();
+
+	Selection::MergeCandidates(a_generation.unindexed, iter != raceIndex.end() ? std::addressof(iter->second) : nullptr, a_candidates);
+}
+
 void ReplacerManager::ApplyReplacers(RE::NiAVObject* a_playerObj)
 {
 	if (!_enabled)
 		return;
 
-	const auto replacers = _current.load();
+	Profiler::ScopedPhase phase{ Phase::kApplyReplacers };
+
+	const auto start = Profiler::clock::now();
+	const auto level = _governor.GetLevel();
+	_frame += 1;
+
+	const auto replacers = _publication.Current();
+	PruneHeld(replacers, level);
 
 	// apply to player
-	ApplyReplacersToActor(replacers, 0x14, a_playerObj);
+	ApplyReplacersToActor(replacers, 0x14, a_playerObj, true);
 
 	RE::NiUpdateData updateData{
 		0.f,
@@ -80,24 +265,113 @@ void ReplacerManager::ApplyReplacers(RE::NiAVObject* a_playerObj)
 	};
 
 	// apply to NPCs
-	RE::ProcessLists::GetSingleton()->ForEachHighActor([&replacers, &updateData](RE::Actor* a_actor) {
-		if (const auto obj = a_actor->Get3D(false)) {
-			if (ApplyReplacersToActor(replacers, a_actor->GetFormID(), obj)) {
+	if (level < Governor::Level::kPlayerOnly) {
+		const auto origin = RE::PlayerCharacter::GetSingleton()->GetPosition();
+
+		RE::ProcessLists::GetSingleton()->ForEachHighActor([&replacers, &updateData, level, origin](RE::Actor* a_actor) {
+			const auto id = a_actor->GetFormID();
+
+			const auto obj = a_actor->Get3D(false);
+			if (!obj)
+				return RE::BSContainer::ForEachResult::kContinue;
+
+			// alternating by form id spreads the NPCs evenly over both frames, the skipped frame keeps the last pose
+			// so the animation doesn't show through, only the live limits and pose matching run at half rate
+			const bool halfRate = level >= Governor::Level::kHalfRate;
+			if (halfRate && ((id + _frame) & 1) && RestoreHeld(id, obj)) {
+				Profiler::ScopedPhase update{ Phase::kNodeUpdate };
 				obj->Update(updateData);
+				return RE::BSContainer::ForEachResult::kContinue;
 			}
-		}
-		
-		return RE::BSContainer::ForEachResult::kContinue;
-	});
+
+			const bool limits = level < Governor::Level::kNearLimits || origin.GetDistance(a_actor->GetPosition()) <= Settings::fNearDistance;
+
+			if (ApplyReplacersToActor(replacers, id, obj, limits)) {
+				if (halfRate) {
+					_pose.Capture(_held[id]);
+				}
+
+				Profiler::ScopedPhase update{ Phase::kNodeUpdate };
+				obj->Update(updateData);
+			}
+
+			return RE::BSContainer::ForEachResult::kContinue;
+		});
+	}
+
+	if (_governor.Update(Profiler::clock::now() - start)) {
+		logger::info("governor: quality {} -> {} (budget {}us)", magic_enum::enum_name(level), magic_enum::enum_name(_governor.GetLevel()), Settings::uFrameBudgetUs);
+	}
 }
 
-bool ReplacerManager::ApplyReplacersToActor(const std::shared_ptr<ReplacerMap>& a_map, RE::FormID a_id, RE::NiAVObject* a_obj)
+bool ReplacerManager::ApplyReplacersToActor(const std::shared_ptr<ReplacerMap>& a_map, RE::FormID a_id, RE::NiAVObject* a_obj, bool a_limits)
 {
 	const auto iter = a_map->find(a_id);
 	if (iter != a_map->end()) {
-		const auto& actorReplacers = iter->second;
-		for (const auto& repl : actorReplacers) {
-			repl->Apply(a_obj);
+		TRACE_SCOPE("ApplyReplacersToActor", a_id);
+
+		// shared with every actor of the same selection, only read here
+		const auto& composed = *iter->second;
+
+		_pose.Begin(a_obj);
+
+		// the frames are matched against the animated pose, before any replacer overrides the key bones
+		if (!composed.matched.empty()) {
+			Profiler::ScopedPhase match{ Phase::kMatchPose };
+			_query.clear();
+			for (const auto& [replacer, payload] : composed.matched) {
+				replacer->DescribePose(*payload, _pose, _query);
+			}
+		}
+
+		for (const auto& override : composed.overrides) {
+			if (const auto transform = _pose.Get(override.bone)) {
+				Replacer::ApplyOverride(*transform, override);
+			}
+		}
+
+		if (a_limits && !composed.limits.empty()) {
+			Profiler::ScopedPhase phase{ Phase::kApplyLimits };
+			for (const auto& live : composed.limits) {
+				if (const auto transform = _pose.Get(live.limit->bone)) {
+					Replacer::ApplyLimit(*transform, *live.limit, live.channels);
+				}
+			}
+		}
+
+		for (const auto& [limited, unlimited, profilerId] : composed.kernels) {
+			const auto kernel = a_limits ? limited : unlimited;
+			const auto& bones = kernel->GetBones();
+
+			// resolve every slot first, slots may move while new ones are added
+			for (const auto bone : bones) {
+				_pose.Get(bone);
+			}
+
+			_kernelArgs.clear();
+			for (const auto bone : bones) {
+				const auto transform = _pose.Get(bone);
+				_kernelArgs.push_back(transform ? transform : std::addressof(_scratch));
+			}
+
+			// nothing is composed for these, applying them is their whole cost
+			const auto start = Profiler::clock::now();
+			(*kernel)(_kernelArgs.data());
+			Profiler::RecordApply(profilerId, Profiler::clock::now() - start);
+		}
+
+		const float* query = _query.data();
+		for (const auto& [replacer, payload] : composed.matched) {
+			Profiler::ScopedPhase match{ Phase::kMatchPose };
+			const auto start = Profiler::clock::now();
+			replacer->ApplyMatched(*payload, _pose, query, a_limits);
+			Profiler::RecordApply(replacer->GetProfilerId(), Profiler::clock::now() - start);
+			query += payload->index.GetStride();
+		}
+
+		{
+			Profiler::ScopedPhase commit{ Phase::kCommitPose };
+			_pose.Commit();
 		}
 		return true;
 	}
@@ -105,53 +379,163 @@ bool ReplacerManager::ApplyReplacersToActor(const std::shared_ptr<ReplacerMap>&
 	return false;
 }
 
+// Writes the transforms of the actor's last apply again, false if there are none and it needs a full apply
+bool ReplacerManager::RestoreHeld(RE::FormID a_id, RE::NiAVObject* a_obj)
+{
+	const auto iter = _held.find(a_id);
+	if (iter == _held.end())
+		return false;
+
+	TRACE_SCOPE("RestoreHeld", a_id);
+
+	_pose.Begin(a_obj);
+	_pose.Restore(iter->second);
+
+	Profiler::ScopedPhase commit{ Phase::kCommitPose };
+	_pose.Commit();
+
+	return true;
+}
+
+// Drops held poses once the level recovers, and those of actors a new evaluation no longer selects anything for
+void ReplacerManager::PruneHeld(const std::shared_ptr<ReplacerMap>& a_map, Governor::Level a_level)
+{
+	if (a_level < Governor::Level::kHalfRate) {
+		_held.clear();
+		_heldMap.reset();
+		return;
+	}
+
+	if (_heldMap == a_map)
+		return;
+
+	std::erase_if(_held, [&a_map](const auto& a_entry) {
+		return !a_map->contains(a_entry.first);
+	});
+	_heldMap = a_map;
+}
+
 void ReplacerManager::Init()
 {
-	_current = std::make_shared<ReplacerMap>();
+	_publication.Replace(std::make_shared<const Generation>(), std::make_shared<ReplacerMap>());
 
 	logger::info("ReplacerManager::Init");
 
-	const std::string dir{ "Data\\SKSE\\PartialAnimationReplacer\\Replacers" };
-	if (fs::exists(dir)) {
-		for (const auto& entry : fs::directory_iterator(dir)) {
-			if (!entry.is_directory()) {
-				continue;
+	_governor.Configure(Governor::Config{ .budgetUs = static_cast<float>(Settings::uFrameBudgetUs) });
+
+	if (!Settings::sStatsFile.empty()) {
+		StatsExport::Open(Settings::sStatsFile);
+	}
+
+	// file I/O and parsing stay off the loading screen, only the form lookups need the main thread
+	std::thread([]() {
+		Tracer::SetThreadName("init");
+		TRACE_SCOPE("ReplacerManager::Init");
+
+		const auto memoryBefore = Util::GetResidentMemory();
+		const auto start = std::chrono::steady_clock::now();
+
+		ParsedFiles files;
+
+		const std::string dir{ "Data\\SKSE\\PartialAnimationReplacer\\Replacers" };
+		if (fs::exists(dir)) {
+			for (const auto& entry : fs::directory_iterator(dir)) {
+				if (!entry.is_directory()) {
+					continue;
+				}
+
+				ReadDir(entry, files);
 			}
+		} else {
+			logger::info("replacement dir does not exist");
+		}
+
+		const auto read = std::chrono::steady_clock::now();
 
-			LoadDir(entry);
+		// payloads, frame interning, bone maps and kernels don't need the main thread either
+		auto built = std::make_shared<std::vector<BuiltReplacer>>();
+		for (auto& [fileName, data] : files) {
+			try {
+				built->push_back(Build(fileName, std::move(data)));
+			} catch (std::exception& e) {
+				logger::info("failed to load {} - {}", fileName, e.what());
+			}
 		}
-	} else {
-		logger::info("replacement dir does not exist");
-	}
 
-	Sort();
+		const auto ready = std::chrono::steady_clock::now();
+		const auto ms = [](auto a_duration) { return std::chrono::duration_cast<std::chrono::milliseconds>(a_duration).count(); };
+		logger::info("init: read {} files in {}ms, built in {}ms", files.size(), ms(read - start), ms(ready - read));
+
+		SKSE::GetTaskInterface()->AddTask([built, memoryBefore, ready, ms]() {
+			const auto queued = std::chrono::steady_clock::now();
+
+			auto generation = std::make_shared<Generation>();
+			for (auto& replacer : *built) {
+				Register(std::move(replacer), *generation);
+			}
+
+			const auto registered = std::chrono::steady_clock::now();
+			const auto count = generation->replacers.size();
+			{
+				std::unique_lock lock{ _writeMutex };
+				Publish(std::move(generation));
+			}
+
+			_ready.store(true, std::memory_order_release);
+
+			const auto published = std::chrono::steady_clock::now();
+			logger::info("init: waited {}ms for the main thread, resolved forms in {}ms, sorted and indexed in {}ms",
+				ms(queued - ready), ms(registered - queued), ms(published - registered));
+
+			logger::info("loaded {} replacers: {} unique bones, {} unique frames ({} shared), resident memory {} KiB -> {} KiB",
+				count, BoneTable::Size(), FramePool::GetInternedCount(), FramePool::GetSharedCount(),
+				memoryBefore / 1024, Util::GetResidentMemory() / 1024);
+		});
+	}).detach();
 }
 
-void ReplacerManager::LoadDir(const fs::directory_entry& a_dir)
+void ReplacerManager::ReadDir(const fs::directory_entry& a_dir, ParsedFiles& a_files)
 {
 	logger::info("Processing directory {}", a_dir.path().string());
-	int found = 0;
+	const auto before = a_files.size();
+
+	// a bundle built from the current files of the directory saves parsing them one by one
+	if (ReplacerReader::ReadBundle(a_dir.path(), a_files)) {
+		logger::info("read {} replacer from the bundle of directory {}", a_files.size() - before, a_dir.path().string());
+		return;
+	}
+
 	for (const auto& file : fs::directory_iterator(a_dir)) {
 		if (file.is_directory())
 			continue;
 
-		found += (int)LoadFile(file);
+		ReadFile(file, a_files);
 	}
-	logger::info("loaded {} replacer from directory {}", found, a_dir.path().string());
+	logger::info("read {} replacer from directory {}", a_files.size() - before, a_dir.path().string());
 }
 
 bool ReplacerManager::ReloadFile(const fs::directory_entry& a_file)
 {
-	std::unique_lock lock{ _mutex };  // prevent read/writes from replacers
-	
-	// invalidate current replacers
-	auto replacers = std::make_shared<ReplacerMap>();
-	replacers = _current.exchange(replacers);
+	if (!IsReady()) {
+		logger::info("can't reload {} before the replacers finished loading", a_file.path().string());
+		return false;
+	}
 
-	return LoadFile(a_file);
+	std::unique_lock lock{ _writeMutex, std::defer_lock };  // only other writers, evaluation keeps its pinned generation
+	{
+		TRACE_SCOPE("ReplacerManager::_writeMutex wait");
+		lock.lock();
+	}
+
+	// replacers are shared, copying the generation doesn't copy any of them
+	auto generation = std::make_shared<Generation>(*_publication.Pin());
+	const bool loaded = LoadFile(a_file, *generation);
+	Publish(std::move(generation));
+
+	return loaded;
 }
 
-bool ReplacerManager::LoadFile(const fs::directory_entry& a_file)
+bool ReplacerManager::ReadFile(const fs::directory_entry& a_file, ParsedFiles& a_files)
 {
 	logger::info("Processing file {}", a_file.path().string());
 
@@ -162,26 +546,31 @@ bool ReplacerManager::LoadFile(const fs::directory_entry& a_file)
 
 	const std::string fileName{ a_file.path().string() };
 
+	TRACE_SCOPE("ReadFile");
+
 	try {
 		logger::info("loading {}", fileName);
 
-		std::ifstream f{ fileName };
-		const auto data = json::parse(f);
-		const auto replacer = std::make_shared<Replacer>(data.get<ReplacerData>());
+		std::ifstream f{ fileName, std::ios::binary };
+		a_files.emplace_back(fileName, ReplacerReader::Read(f));
 
-		if (replacer->IsValid(fileName)) {
-			if (_paths.count(fileName)) {
-				_replacers[_paths[fileName]] = replacer;
-			} else {
-				_paths[fileName] = _replacers.size();
-				_replacers.emplace_back(replacer);
-			}
-		} else if (_paths.count(fileName)) {
-			_replacers.erase(_replacers.begin() + _paths[fileName]);
-			_paths.erase(fileName);
-		}
+		return true;
+	} catch (std::exception& e) {
+		logger::info("failed to load {} - {}", fileName, e.what());
 
-		Sort();
+		return false;
+	}
+}
+
+bool ReplacerManager::LoadFile(const fs::directory_entry& a_file, Generation& a_generation)
+{
+	ParsedFiles files;
+	if (!ReadFile(a_file, files))
+		return false;
+
+	auto& [fileName, data] = files[0];
+	try {
+		Register(Build(fileName, std::move(data)), a_generation);
 
 		return true;
 	} catch (std::exception& e) {
@@ -191,9 +580,134 @@ bool ReplacerManager::LoadFile(const fs::directory_entry& a_file)
 	}
 }
 
-void ReplacerManager::Sort()
+// Everything but the form lookups, safe off the main thread
+BuiltReplacer ReplacerManager::Build(const std::string& a_fileName, ReplacerData&& a_data)
 {
-	std::ranges::sort(_replacers, [](const auto& a, const auto& b) {
+	TRACE_SCOPE("Build");
+
+	const bool mirror = a_data.mirror;
+
+	BuiltReplacer built{ a_fileName, std::make_shared<Replacer>(std::move(a_data), a_fileName) };
+	if (mirror) {
+		// takes the bones and limits the source kept for it
+		built.mirrored = std::make_shared<Replacer>(built.replacer);
+	}
+
+	return built;
+}
+
+// Resolves the forms of a built replacer, then adds, replaces or removes the replacer of its file
+// the generation is sorted when published
+bool ReplacerManager::Register(BuiltReplacer&& a_built, Generation& a_generation)
+{
+	auto& replacers = a_generation.replacers;
+	auto& paths = a_generation.paths;
+
+	const auto put = [&](const std::string& a_path, const std::shared_ptr<Replacer>& a_replacer) {
+		if (const auto previous = paths.find(a_path); previous != paths.end()) {
+			Residency::Forget(previous->second);
+			std::ranges::replace(replacers, previous->second, a_replacer);
+			previous->second = a_replacer;
+		} else {
+			paths[a_path] = a_replacer;
+			replacers.emplace_back(a_replacer);
+		}
+	};
+
+	const auto remove = [&](const std::string& a_path) {
+		if (const auto previous = paths.find(a_path); previous != paths.end()) {
+			Residency::Forget(previous->second);
+			std::erase(replacers, previous->second);
+			paths.erase(previous);
+		}
+	};
+
+	const auto& fileName = a_built.file;
+	const auto& replacer = a_built.replacer;
+	const auto& mirrored = a_built.mirrored;
+
+	// the mirrored view lives next to its source, keyed by the file name and a suffix
+	const auto mirrorPath = fileName + std::string{ Replacer::MIRROR_SUFFIX };
+
+	// conditions compile here, a malformed comparand or param throws out of the parser
+	// the generation keeps what it had for the file, like a file that failed to read
+	try {
+		replacer->ResolveForms();
+		if (mirrored) {
+			mirrored->ResolveForms();
+		}
+	} catch (std::exception& e) {
+		logger::info("failed to load {} - {}", fileName, e.what());
+
+		return false;
+	}
+
+	if (replacer->IsValid(fileName)) {
+		if (mirrored) {
+			if (mirrored->IsValid(mirrorPath)) {
+				put(mirrorPath, mirrored);
+			} else {
+				remove(mirrorPath);
+			}
+		} else {
+			remove(mirrorPath);
+		}
+
+		put(fileName, replacer);
+
+		return true;
+	}
+
+	remove(fileName);
+	remove(mirrorPath);
+
+	return false;
+}
+
+// must be called with _writeMutex held, the previous generation is freed once the last reader releases it
+void ReplacerManager::Publish(std::shared_ptr<Generation> a_generation)
+{
+	a_generation->version = _nextVersion++;
+	Sort(*a_generation);
+
+	// the selections of the previous generation may reference replaced files
+	_publication.Replace(std::move(a_generation), std::make_shared<ReplacerMap>());
+}
+
+void ReplacerManager::Sort(Generation& a_generation)
+{
+	std::ranges::sort(a_generation.replacers, [](const auto& a, const auto& b) {
 		return a->GetPriority() > b->GetPriority();
 	});
+
+	BuildIndex(a_generation);
+}
+
+void ReplacerManager::BuildIndex(Generation& a_generation)
+{
+	const auto& replacers = a_generation.replacers;
+
+	a_generation.raceIndex.clear();
+	a_generation.unindexed.clear();
+
+	a_generation.raceFeatures.clear();
+	a_generation.unindexedFeatures = 0;
+
+	Selection::BuildCoverage(replacers.size(), [&replacers](std::size_t a_index) -> const BoneSet& {
+		return replacers[a_index]->GetBoneset();
+	}, a_generation.suffixCoverage);
+
+	for (std::uint32_t i = 0; i < replacers.size(); ++i) {
+		if (const auto race = replacers[i]->GetPrefilter().race) {
+			a_generation.raceIndex[race->GetFormID()].push_back(i);
+			a_generation.raceFeatures[race->GetFormID()] |= replacers[i]->GetFingerprintFeatures();
+		} else {
+			a_generation.unindexed.push_back(i);
+			a_generation.unindexedFeatures |= replacers[i]->GetFingerprintFeatures();
+		}
+	}
+
+	for (auto& features : a_generation.raceFeatures | std::views::values) {
+		features |= a_generation.unindexedFeatures;
+	}
 }
\ No newline at end of file
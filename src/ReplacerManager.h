@@ -1,11 +1,76 @@
 #pragma once
 
 #include "Replacer.h"
+#include "Pose.h"
+#include "Kernel.h"
+#include "Governor.h"
+#include "Publication.h"
 
 namespace PAR
 {
-	typedef std::unordered_map<RE::FormID, std::vector<std::shared_ptr<Replacer>>> ReplacerMap;
+	// Selected replacers of an actor and their static result, composed on the evaluation thread
+	struct ComposedPose
+	{
+		std::vector<std::shared_ptr<Replacer>> replacers;
+
+		std::vector<PoseOverride> overrides;
+		std::vector<LiveLimit> limits;
+
+		// replacers applied by their generated code instead of the lists above, with and without their live limits
+		struct ComposedKernel
+		{
+			const Kernel* limited;
+			const Kernel* unlimited;
+			std::uint32_t profilerId;
+		};
+		std::vector<ComposedKernel> kernels;
+
+		// replacers whose frame depends on the live pose, with their pinned payload
+		std::vector<std::pair<const Replacer*, std::shared_ptr<const Payload>>> matched;
+
+		// keeps the live limits alive if a replacer is evicted
+		std::vector<std::shared_ptr<const Payload>> payloads;
+	};
+
+	// actors with the same selection share one composed pose
+	typedef std::unordered_map<RE::FormID, std::shared_ptr<const ComposedPose>> ReplacerMap;
+	typedef std::vector<std::pair<std::string, ReplacerData>> ParsedFiles;
+
+	// a replacer and its mirrored view built off the main thread, waiting for their form lookups
+	struct BuiltReplacer
+	{
+		std::string file;
+		std::shared_ptr<Replacer> replacer;
+		std::shared_ptr<Replacer> mirrored;
+	};
+
+	struct CachedSelection
+	{
+		std::uint64_t fingerprint;
+		std::vector<std::shared_ptr<Replacer>> replacers;
+	};
 	
+	// Immutable snapshot of the loaded replacers, readers pin one without taking any lock
+	struct Generation
+	{
+		std::uint64_t version = 0;
+
+		std::vector<std::shared_ptr<Replacer>> replacers;
+		std::map<std::string, std::shared_ptr<Replacer>> paths;
+
+		// indices into replacers, partitioned by the race a replacer requires
+		std::unordered_map<RE::FormID, std::vector<std::uint32_t>> raceIndex;
+		std::vector<std::uint32_t> unindexed;
+
+		// union of the bones of replacers[i..], lets selection stop once nothing left can be accepted
+		std::vector<BoneSet> suffixCoverage;
+
+		// fingerprint features of each candidate set, the unindexed ones are part of every race's
+		// an uncacheable replacer only turns the cache off for the actors it can be a candidate for
+		std::uint32_t unindexedFeatures = 0;
+		std::unordered_map<RE::FormID, std::uint32_t> raceFeatures;
+	};
+
 	class ReplacerManager
 	{
 	public:
@@ -17,21 +82,66 @@ namespace PAR
 		static void EvaluateReplacers();
 
 		static void SetEnabled(bool a_enabled) { _enabled = a_enabled; }
+
+		// false until Init published the first generation, hooks skip all work until then
+		static bool IsReady() { return _ready.load(std::memory_order_acquire); }
+
+		static Governor::Level GetQualityLevel() { return _governor.GetLevel(); }
 	private:
-		static void LoadDir(const fs::directory_entry& a_dir);
-		static bool LoadFile(const fs::directory_entry& a_file);
+		static void ReadDir(const fs::directory_entry& a_dir, ParsedFiles& a_files);
+		static bool ReadFile(const fs::directory_entry& a_file, ParsedFiles& a_files);
+		static bool LoadFile(const fs::directory_entry& a_file, Generation& a_generation);
+		static BuiltReplacer Build(const std::string& a_fileName, ReplacerData&& a_data);
+		static bool Register(BuiltReplacer&& a_built, Generation& a_generation);
 
-		static void FindReplacersForActor(RE::Actor* a_actor, ReplacerMap& map);
-		static bool ApplyReplacersToActor(const std::shared_ptr<ReplacerMap>& a_map, RE::FormID a_id, RE::NiAVObject* a_obj);
+		static void FindReplacersForActor(const Generation& a_generation, RE::Actor* a_actor, std::vector<std::shared_ptr<Replacer>>& a_selected);
+		static void Compose(ComposedPose& a_pose);
+		static bool ApplyReplacersToActor(const std::shared_ptr<ReplacerMap>& a_map, RE::FormID a_id, RE::NiAVObject* a_obj, bool a_limits);
+		static bool RestoreHeld(RE::FormID a_id, RE::NiAVObject* a_obj);
+		static void PruneHeld(const std::shared_ptr<ReplacerMap>& a_map, Governor::Level a_level);
 
-		static void Sort();
+		static void Publish(std::shared_ptr<Generation> a_generation);
+		static void Sort(Generation& a_generation);
+		static void BuildIndex(Generation& a_generation);
+		static void GetCandidates(const Generation& a_generation, RE::Actor* a_actor, std::vector<std::uint32_t>& a_candidates);
 
-		static inline std::vector<std::shared_ptr<Replacer>> _replacers;
-		static inline std::map<std::string, std::size_t> _paths;
+		// the generation and the selections evaluated from it
+		static inline Publication<Generation, ReplacerMap> _publication;
+		static inline std::uint64_t _nextVersion = 1;
+
+		// serializes writers, readers keep using the generation they pinned
+		static inline std::mutex _writeMutex;
+
+		// selections from the previous pass, reused while the actor's fingerprint is unchanged
+		static inline std::unordered_map<RE::FormID, CachedSelection> _cache;
+		static inline std::unordered_map<RE::FormID, CachedSelection> _nextCache;
+		static inline std::uint64_t _cacheVersion = 0;
+		static inline std::uint32_t _passes = 0;
+
+		// cache lookups of the current pass, for the stats export
+		static inline std::uint32_t _passHits = 0;
+		static inline std::uint32_t _passMisses = 0;
+
+		// guards the selection cache between overlapping evaluation passes, never taken by writers
+		static inline std::mutex _evalMutex;
 
 		static inline bool _enabled = true;
+		static inline std::atomic<bool> _ready = false;
+
+		// reused for every actor, only touched by ApplyReplacers
+		static inline Pose _pose;
+		static inline std::vector<RE::NiTransform*> _kernelArgs;
+		static inline std::vector<float> _query;
+
+		// stands in for the bones an actor doesn't have
+		static inline RE::NiTransform _scratch;
+
+		// fed with the cost of every ApplyReplacers call, only touched by it after Init
+		static inline Governor _governor;
+		static inline std::uint32_t _frame = 0;
 
-		static inline std::mutex _mutex;
-		static inline std::atomic<std::shared_ptr<ReplacerMap>> _current;
+		// at kHalfRate, the pose each NPC was last applied with, written again on the frames it is skipped
+		static inline std::unordered_map<RE::FormID, Pose::Snapshot> _held;
+		static inline std::shared_ptr<ReplacerMap> _heldMap;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,379 @@
+#include "ReplacerReader.h"
+#include "BundleFormat.h"
+
+using namespace PAR;
+
+template <class Input>
+ReplacerData ReplacerReader::Read(Input&& a_input, json::input_format_t a_format)
+{
+	ReplacerReader reader;
+
+	// same defaults as from_json
+	reader._data.priority = 0;
+	reader._data.rotate = true;
+	reader._data.translate = false;
+	reader._data.scale = false;
+	reader._data.matchPose = false;
+	reader._data.mirror = false;
+
+	if (!json::sax_parse(std::forward<Input>(a_input), std::addressof(reader), a_format)) {
+		throw std::runtime_error(reader._error.empty() ? "unexpected end of input" : reader._error);
+	}
+
+	return std::move(reader._data);
+}
+
+ReplacerData ReplacerReader::Read(std::istream& a_stream)
+{
+	return Read(a_stream, json::input_format_t::json);
+}
+
+ReplacerData ReplacerReader::ReadMsgpack(const std::vector<std::uint8_t>& a_bytes)
+{
+	return Read(a_bytes, json::input_format_t::msgpack);
+}
+
+// Consumes one element slot of the current container and describes the container that starts in it
+ReplacerReader::Level ReplacerReader::Enter(bool a_array)
+{
+	if (_stack.empty())
+		return Level{ a_array ? Context::kSkip : Context::kRoot };
+
+	auto& parent = _stack.back();
+	const auto index = parent.index++;
+
+	switch (parent.context) {
+	case Context::kRoot:
+		if (a_array && parent.key == "frames")
+			return Level{ Context::kFrames };
+		if (a_array && parent.key == "limits")
+			return Level{ Context::kLimits };
+		if (a_array && parent.key == "conditions")
+			return Level{ Context::kConditions };
+		if (!a_array && parent.key == "refs")
+			return Level{ Context::kRefs };
+		if (a_array && parent.key == "key_bones")
+			return Level{ Context::kKeyBones };
+		break;
+	case Context::kFrames:
+		if (a_array) {
+			_data.frames.emplace_back();
+			return Level{ Context::kFrame };
+		}
+		break;
+	case Context::kFrame:
+		if (!a_array) {
+			_data.frames.back().emplace_back(Override{ BoneTable::INVALID_BONE, RE::NiTransform{} });
+			return Level{ Context::kOverride };
+		}
+		break;
+	case Context::kOverride:
+		{
+			auto& transform = _data.frames.back().back().transform;
+			if (a_array && parent.key == "rotate")
+				return Level{ Context::kRotate };
+			if (!a_array && parent.key == "translate")
+				return Level{ Context::kTranslate, {}, 0, std::addressof(transform.translate.x), 3 };
+		}
+		break;
+	case Context::kRotate:
+		if (a_array && index < 3)
+			return Level{ Context::kFloats, {}, 0, _data.frames.back().back().transform.rotate.entry[index], 3 };
+		break;
+	case Context::kLimits:
+		if (!a_array) {
+			_data.limits.emplace_back(Limit{});
+			return Level{ Context::kLimit };
+		}
+		break;
+	case Context::kLimit:
+		if (a_array) {
+			auto& limit = _data.limits.back();
+			const auto axes = parent.key == "rotate_low"     ? limit.rotate_low.data() :
+			                  parent.key == "rotate_high"    ? limit.rotate_high.data() :
+			                  parent.key == "translate_low"  ? limit.translate_low.data() :
+			                  parent.key == "translate_high" ? limit.translate_high.data() :
+			                                                   nullptr;
+			if (axes)
+				return Level{ Context::kFloats, {}, 0, axes, 3 };
+		}
+		break;
+	default:
+		break;
+	}
+
+	return Level{ Context::kSkip };
+}
+
+bool ReplacerReader::Number(double a_value)
+{
+	if (_stack.empty())
+		return true;
+
+	auto& level = _stack.back();
+	const auto index = level.index++;
+	const auto value = static_cast<float>(a_value);
+
+	switch (level.context) {
+	case Context::kRoot:
+		if (level.key == "priority") {
+			_data.priority = static_cast<std::uint64_t>(a_value);
+		}
+		break;
+	case Context::kOverride:
+		if (level.key == "scale") {
+			_data.frames.back().back().transform.scale = value;
+		}
+		break;
+	case Context::kTranslate:
+		if (level.key.size() == 1 && level.key[0] >= 'x' && level.key[0] <= 'z') {
+			level.floats[level.key[0] - 'x'] = value;
+		}
+		break;
+	case Context::kLimit:
+		if (level.key == "scale_low") {
+			_data.limits.back().scale_low = value;
+		} else if (level.key == "scale_high") {
+			_data.limits.back().scale_high = value;
+		}
+		break;
+	case Context::kFloats:
+		if (index < level.count) {
+			level.floats[index] = value;
+		}
+		break;
+	default:
+		break;
+	}
+
+	return true;
+}
+
+bool ReplacerReader::null()
+{
+	if (!_stack.empty()) {
+		_stack.back().index++;
+	}
+	return true;
+}
+
+bool ReplacerReader::boolean(bool a_value)
+{
+	if (_stack.empty())
+		return true;
+
+	auto& level = _stack.back();
+	level.index++;
+
+	if (level.context == Context::kRoot) {
+		if (level.key == "rotate") {
+			_data.rotate = a_value;
+		} else if (level.key == "translate") {
+			_data.translate = a_value;
+		} else if (level.key == "scale") {
+			_data.scale = a_value;
+		} else if (level.key == "match_pose") {
+			_data.matchPose = a_value;
+		} else if (level.key == "mirror") {
+			_data.mirror = a_value;
+		}
+	}
+
+	return true;
+}
+
+bool ReplacerReader::number_integer(json::number_integer_t a_value)
+{
+	if (!_stack.empty() && _stack.back().context == Context::kRoot && _stack.back().key == "priority") {
+		_stack.back().index++;
+		_data.priority = static_cast<std::uint64_t>(a_value);
+		return true;
+	}
+	return Number(static_cast<double>(a_value));
+}
+
+bool ReplacerReader::number_unsigned(json::number_unsigned_t a_value)
+{
+	if (!_stack.empty() && _stack.back().context == Context::kRoot && _stack.back().key == "priority") {
+		_stack.back().index++;
+		_data.priority = a_value;
+		return true;
+	}
+	return Number(static_cast<double>(a_value));
+}
+
+bool ReplacerReader::number_float(json::number_float_t a_value, const json::string_t&)
+{
+	return Number(a_value);
+}
+
+bool ReplacerReader::string(json::string_t& a_value)
+{
+	if (_stack.empty())
+		return true;
+
+	auto& level = _stack.back();
+	level.index++;
+
+	switch (level.context) {
+	case Context::kOverride:
+		if (level.key == "name") {
+			_data.frames.back().back().bone = BoneTable::Intern(a_value);
+		}
+		break;
+	case Context::kLimit:
+		if (level.key == "name") {
+			_data.limits.back().bone = BoneTable::Intern(a_value);
+		}
+		break;
+	case Context::kConditions:
+		_data.conditions.emplace_back(std::move(a_value));
+		break;
+	case Context::kRefs:
+		_data.refs[level.key] = std::move(a_value);
+		break;
+	case Context::kKeyBones:
+		_data.keyBones.push_back(BoneTable::Intern(a_value));
+		break;
+	default:
+		break;
+	}
+
+	return true;
+}
+
+bool ReplacerReader::binary(json::binary_t&)
+{
+	if (!_stack.empty()) {
+		_stack.back().index++;
+	}
+	return true;
+}
+
+bool ReplacerReader::start_object(std::size_t)
+{
+	_stack.push_back(Enter(false));
+	return true;
+}
+
+bool ReplacerReader::key(json::string_t& a_key)
+{
+	_stack.back().key = std::move(a_key);
+	return true;
+}
+
+bool ReplacerReader::end_object()
+{
+	if (_stack.back().context == Context::kLimit) {
+		// Convert degrees to radians
+		auto& limit = _data.limits.back();
+		for (int i = 0; i < 3; ++i) {
+			limit.rotate_low[i] = RE::deg_to_rad(limit.rotate_low[i]);
+			limit.rotate_high[i] = RE::deg_to_rad(limit.rotate_high[i]);
+		}
+	}
+
+	_stack.pop_back();
+	return true;
+}
+
+bool ReplacerReader::start_array(std::size_t)
+{
+	_stack.push_back(Enter(true));
+	return true;
+}
+
+bool ReplacerReader::end_array()
+{
+	_stack.pop_back();
+	return true;
+}
+
+bool ReplacerReader::parse_error(std::size_t, const std::string&, const json::exception& a_error)
+{
+	_error = a_error.what();
+	return false;
+}
+
+bool ReplacerReader::ReadBundle(const fs::path& a_dir, std::vector<std::pair<std::string, ReplacerData>>& a_out)
+{
+	const auto path = a_dir / Bundle::NAME;
+	if (!fs::exists(path))
+		return false;
+
+	const auto readBytes = [](const fs::path& a_path) {
+		std::ifstream file{ a_path, std::ios::binary | std::ios::ate };
+		std::vector<std::uint8_t> bytes(static_cast<std::size_t>(file.tellg()));
+
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+		return bytes;
+	};
+
+	std::vector<std::pair<std::string, ReplacerData>> replacers;
+
+	try {
+		const auto bundle = json::from_msgpack(readBytes(path));
+		if (bundle.value("version", 0u) != Bundle::VERSION) {
+			logger::warn("{}: unsupported bundle version, reading the json files instead", path.string());
+			return false;
+		}
+
+		std::unordered_map<std::string, const json*> entries;
+		for (const auto& entry : bundle.at("files")) {
+			entries[entry.at("file").get<std::string>()] = std::addressof(entry);
+		}
+
+		std::size_t files = 0;
+		for (const auto& file : fs::directory_iterator(a_dir)) {
+			if (file.is_directory() || file.path().extension() != ".json")
+				continue;
+
+			files += 1;
+
+			const auto stale = [&]() {
+				logger::warn("{}: stale, {} changed since it was built, reading the json files instead", path.string(), file.path().filename().string());
+				return false;
+			};
+
+			const auto iter = entries.find(file.path().filename().string());
+			if (iter == entries.end() || iter->second->at("size").get<std::uint64_t>() != file.file_size())
+				return stale();
+
+			// the same size and write time is taken as unchanged, only a touched file is read and hashed
+			std::vector<std::uint8_t> bytes;
+			if (iter->second->at("mtime").get<std::int64_t>() != Bundle::WriteTime(file.path())) {
+				bytes = readBytes(file.path());
+				if (iter->second->at("hash").get<std::uint64_t>() != Bundle::Hash(bytes.data(), bytes.size()))
+					return stale();
+			}
+
+			const auto& data = iter->second->at("data");
+			if (data.is_binary()) {
+				replacers.emplace_back(file.path().string(), ReadMsgpack(data.get_binary()));
+				continue;
+			}
+
+			// didn't parse when the bundle was built, reported the same way a plain load reports it
+			try {
+				if (bytes.empty()) {
+					bytes = readBytes(file.path());
+				}
+				replacers.emplace_back(file.path().string(), Read(bytes, json::input_format_t::json));
+			} catch (std::exception& e) {
+				logger::info("failed to load {} - {}", file.path().string(), e.what());
+			}
+		}
+
+		if (files != entries.size()) {
+			logger::warn("{}: stale, lists files that were removed, reading the json files instead", path.string());
+			return false;
+		}
+	} catch (std::exception& e) {
+		logger::error("failed to read bundle {} - {}", path.string(), e.what());
+		return false;
+	}
+
+	std::ranges::move(replacers, std::back_inserter(a_out));
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Replacer.h"
+
+namespace PAR
+{
+	// Streams a replacer file into ReplacerData in one pass, without building a json DOM
+	class ReplacerReader
+	{
+	public:
+		// throws std::runtime_error on malformed input, like json::parse
+		static ReplacerData Read(std::istream& a_stream);
+
+		// a replacer file re-encoded as msgpack, as stored in bundles
+		static ReplacerData ReadMsgpack(const std::vector<std::uint8_t>& a_bytes);
+
+		// appends the replacers of a_dir's bundle, false if it has none or it no longer matches the .json files next to it
+		static bool ReadBundle(const fs::path& a_dir, std::vector<std::pair<std::string, ReplacerData>>& a_out);
+
+		// nlohmann::json_sax interface
+		bool null();
+		bool boolean(bool a_value);
+		bool number_integer(json::number_integer_t a_value);
+		bool number_unsigned(json::number_unsigned_t a_value);
+		bool number_float(json::number_float_t a_value, const json::string_t& a_raw);
+		bool string(json::string_t& a_value);
+		bool binary(json::binary_t& a_value);
+		bool start_object(std::size_t a_size);
+		bool key(json::string_t& a_key);
+		bool end_object();
+		bool start_array(std::size_t a_size);
+		bool end_array();
+		bool parse_error(std::size_t a_position, const std::string& a_token, const json::exception& a_error);
+
+	private:
+		enum class Context
+		{
+			kRoot,
+			kFrames,
+			kFrame,
+			kOverride,
+			kRotate,
+			kTranslate,
+			kLimits,
+			kLimit,
+			kFloats,
+			kConditions,
+			kRefs,
+			kKeyBones,
+			kSkip
+		};
+
+		struct Level
+		{
+			Context context;
+			std::string key;
+			std::size_t index = 0;
+
+			// destination of kFloats and kTranslate
+			float* floats = nullptr;
+			std::size_t count = 0;
+		};
+
+		ReplacerData _data;
+		std::vector<Level> _stack;
+		std::string _error;
+
+		template <class Input>
+		static ReplacerData Read(Input&& a_input, json::input_format_t a_format);
+
+		Level Enter(bool a_array);
+		bool Number(double a_value);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "Residency.h"
+#include "Replacer.h"
+#include "Settings.h"
+
+using namespace PAR;
+
+void Residency::BeginPass()
+{
+	std::unique_lock lock{ _mutex };
+	_pass += 1;
+}
+
+void Residency::Touch(const std::shared_ptr<Replacer>& a_replacer)
+{
+	// mirrored views share the payload of their source
+	if (const auto& source = a_replacer->GetSource()) {
+		Touch(source);
+		return;
+	}
+
+	std::unique_lock lock{ _mutex };
+
+	// selected by an evaluation that still pins the generation it was removed from, its results are dropped
+	if (a_replacer->IsRetired())
+		return;
+
+	if (const auto iter = _entries.find(a_replacer.get()); iter != _entries.end() && a_replacer->IsResident()) {
+		iter->second->pass = _pass;
+		_lru.splice(_lru.begin(), _lru, iter->second);
+		return;
+	}
+
+	if (!a_replacer->MakeResident())
+		return;
+
+	if (const auto iter = _entries.find(a_replacer.get()); iter != _entries.end()) {
+		_residentBytes -= iter->second->size;
+		_lru.erase(iter->second);
+		_entries.erase(iter);
+	}
+
+	const auto size = a_replacer->GetResidentSize();
+	_lru.push_front(Entry{ a_replacer.get(), a_replacer, size, _pass });
+	_entries[a_replacer.get()] = _lru.begin();
+	_residentBytes += size;
+
+	logger::info("loaded payload of {} ({} KiB resident)", a_replacer->GetName(), _residentBytes / 1024);
+
+	EvictToBudget();
+}
+
+void Residency::Forget(const std::shared_ptr<Replacer>& a_replacer)
+{
+	std::unique_lock lock{ _mutex };
+
+	a_replacer->Retire();
+
+	if (const auto iter = _entries.find(a_replacer.get()); iter != _entries.end()) {
+		_residentBytes -= iter->second->size;
+		_lru.erase(iter->second);
+		_entries.erase(iter);
+	}
+}
+
+// must be called with _mutex held, never evicts a replacer touched in the current pass
+// those are all at the front, the budget may be exceeded until the next pass
+void Residency::EvictToBudget()
+{
+	const auto budget = Settings::uMemoryBudget;
+	if (budget == 0)
+		return;
+
+	while (_residentBytes > budget && !_lru.empty() && _lru.back().pass != _pass) {
+		auto& entry = _lru.back();
+		if (const auto replacer = entry.replacer.lock()) {
+			replacer->Evict();
+			logger::info("evicted payload of {}", replacer->GetName());
+		}
+
+		_residentBytes -= entry.size;
+		_entries.erase(entry.key);
+		_lru.pop_back();
+	}
+}
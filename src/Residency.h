@@ -0,0 +1,38 @@
+#pragma once
+
+namespace PAR
+{
+	class Replacer;
+
+	// LRU over replacers whose transform payload is resident, used in lazy load mode
+	class Residency
+	{
+	public:
+		// replacers touched after BeginPass are not evicted until the next one, selection and compose
+		// of one evaluation pass can rely on the payloads of everything they touched
+		static void BeginPass();
+		static void Touch(const std::shared_ptr<Replacer>& a_replacer);
+		// a_replacer left the generation, its payload is no longer accounted for and it is never loaded again
+		static void Forget(const std::shared_ptr<Replacer>& a_replacer);
+
+		static std::size_t GetResidentBytes() { return _residentBytes; }
+
+	private:
+		struct Entry
+		{
+			const Replacer* key;
+			std::weak_ptr<Replacer> replacer;
+			std::size_t size;
+			std::uint64_t pass;
+		};
+
+		static void EvictToBudget();
+
+		static inline std::list<Entry> _lru;
+		static inline std::unordered_map<const Replacer*, std::list<Entry>::iterator> _entries;
+		static inline std::size_t _residentBytes = 0;
+		static inline std::uint64_t _pass = 0;
+
+		static inline std::mutex _mutex;
+	};
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "BoneSet.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+// Priority and bone-conflict selection, free of game types so recorded sessions
+// can be fed through the same code offline by tools/SelectionReplay
+
+namespace PAR::Selection
+{
+	// a_coverage[i] is the union of the bones of replacers i.., with an empty set at the end
+	template <class Bones>
+	void BuildCoverage(std::size_t a_count, Bones&& a_bones, std::vector<BoneSet>& a_coverage)
+	{
+		a_coverage.assign(a_count + 1, BoneSet{});
+		for (auto i = a_count; i-- > 0;) {
+			a_coverage[i] = a_coverage[i + 1];
+			a_coverage[i].Merge(a_bones(i));
+		}
+	}
+
+	// Merges the replacers without a race requirement with those requiring the actor's race, both sorted by index
+	inline void MergeCandidates(const std::vector<std::uint32_t>& a_unindexed, const std::vector<std::uint32_t>* a_race, std::vector<std::uint32_t>& a_candidates)
+	{
+		if (!a_race) {
+			a_candidates = a_unindexed;
+			return;
+		}
+
+		a_candidates.reserve(a_unindexed.size() + a_race->size());
+		std::ranges::merge(a_unindexed, *a_race, std::back_inserter(a_candidates));
+	}
+
+	// Walks a_candidates in decreasing priority and accepts every replacer whose bones are still free and whose conditions pass
+	// a_accept(i) evaluates the conditions of replacer i, a_emit(i) is called for each accepted one
+	template <class Bones, class Accept, class Emit>
+	void Select(const std::vector<std::uint32_t>& a_candidates, const std::vector<BoneSet>& a_coverage, Bones&& a_bones, Accept&& a_accept, Emit&& a_emit)
+	{
+		BoneSet replaced;
+		for (const auto index : a_candidates) {
+			// every remaining replacer overlaps an already replaced bone
+			if (a_coverage[index].IsSubsetOf(replaced))
+				break;
+
+			// test for no shared bones before paying for the conditions
+			const BoneSet& incoming = a_bones(index);
+			if (replaced.Intersects(incoming))
+				continue;
+
+			if (a_accept(index)) {
+				a_emit(index);
+				replaced.Merge(incoming);
+			}
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#include "Settings.h"
+
+using namespace PAR;
+
+void Settings::Load()
+{
+	constexpr auto path = "Data\\SKSE\\Plugins\\PartialAnimationReplacer.ini";
+
+	CSimpleIniA ini;
+	ini.SetUnicode();
+
+	if (ini.LoadFile(path) < 0) {
+		logger::info("no settings file found, using defaults");
+		return;
+	}
+
+	bLazyLoad = ini.GetBoolValue("Residency", "bLazyLoad", bLazyLoad);
+	const auto budget = ini.GetLongValue("Residency", "iMemoryBudgetKB", static_cast<long>(uMemoryBudget / 1024));
+	uMemoryBudget = budget > 0 ? static_cast<std::size_t>(budget) * 1024 : 0;
+
+	bCacheSelections = ini.GetBoolValue("Evaluation", "bCacheSelections", bCacheSelections);
+	uFullEvaluationInterval = static_cast<std::uint32_t>(std::max(1l, ini.GetLongValue("Evaluation", "iFullEvaluationInterval", static_cast<long>(uFullEvaluationInterval))));
+
+	bJitKernels = ini.GetBoolValue("Performance", "bJitKernels", bJitKernels);
+	bVerifyJitKernels = ini.GetBoolValue("Performance", "bVerifyJitKernels", bVerifyJitKernels);
+	uFrameBudgetUs = static_cast<std::uint32_t>(std::max(0l, ini.GetLongValue("Performance", "iFrameBudgetUs", static_cast<long>(uFrameBudgetUs))));
+	fNearDistance = static_cast<float>(ini.GetDoubleValue("Performance", "fNearDistance", fNearDistance));
+
+	sStatsFile = ini.GetValue("Stats", "sStatsFile", sStatsFile.c_str());
+
+	logger::info("settings: lazy load {}, memory budget {} KiB", bLazyLoad, uMemoryBudget / 1024);
+	logger::info("settings: cache selections {}, full evaluation every {} passes", bCacheSelections, uFullEvaluationInterval);
+	logger::info("settings: jit kernels {}, verify kernels {}", bJitKernels, bVerifyJitKernels);
+	logger::info("settings: frame budget {}us, near distance {}", uFrameBudgetUs, fNearDistance);
+	logger::info("settings: stats file '{}'", sStatsFile);
+}
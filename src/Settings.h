@@ -0,0 +1,30 @@
+#pragma once
+
+namespace PAR
+{
+	class Settings
+	{
+	public:
+		static void Load();
+
+		// Residency, a budget of 0 disables eviction
+		static inline bool bLazyLoad = false;
+		static inline std::size_t uMemoryBudget = 64 * 1024 * 1024;
+
+		// Evaluation, selections are fully re-evaluated every uFullEvaluationInterval passes
+		static inline bool bCacheSelections = true;
+		static inline std::uint32_t uFullEvaluationInterval = 10;
+
+		// Performance, replacers are applied by generated code, optionally checked against the interpreter at load
+		static inline bool bJitKernels = false;
+		static inline bool bVerifyJitKernels = false;
+
+		// Performance, replacer fidelity is lowered while applying them costs more than uFrameBudgetUs, 0 disables
+		// at the first degraded level limits only run on actors within fNearDistance of the player
+		static inline std::uint32_t uFrameBudgetUs = 0;
+		static inline float fNearDistance = 1024.f;
+
+		// Stats, live counters are published to this memory-mapped file, empty disables
+		static inline std::string sStatsFile;
+	};
+}
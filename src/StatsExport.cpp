@@ -0,0 +1,109 @@
+#include "StatsExport.h"
+#include "ReplacerManager.h"
+
+using namespace PAR;
+
+bool StatsExport::Open(const fs::path& a_path)
+{
+	// readers may have the file mapped from an earlier session, it can't be truncated or replaced while they do,
+	// so an existing file is reused as is and only grown by the mapping if it is too small
+	const auto file = CreateFileW(a_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		logger::error("stats: failed to open {} ({})", a_path.string(), GetLastError());
+		return false;
+	}
+
+	const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, 0, sizeof(StatsLayout), nullptr);
+	CloseHandle(file);
+
+	if (!mapping) {
+		logger::error("stats: failed to map {} ({})", a_path.string(), GetLastError());
+		return false;
+	}
+
+	const auto view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(StatsLayout));
+	CloseHandle(mapping);
+
+	if (!view) {
+		logger::error("stats: failed to map a view of {} ({})", a_path.string(), GetLastError());
+		return false;
+	}
+
+	// the view keeps the mapping alive
+	auto layout = static_cast<StatsLayout*>(view);
+	if (std::atomic_ref{ layout->magic }.load(std::memory_order_acquire) == StatsLayout::MAGIC && layout->version == StatsLayout::VERSION) {
+		// a reader may still be attached, the sequence keeps counting so it never takes a mix of both sessions
+		layout->Reset();
+	} else {
+		// new or of another version, the magic goes last so readers never see a partial header
+		layout = new (view) StatsLayout{};
+		layout->version = StatsLayout::VERSION;
+		layout->size = sizeof(StatsLayout);
+		std::atomic_ref{ layout->magic }.store(StatsLayout::MAGIC, std::memory_order_release);
+	}
+
+	_view = layout;
+	_lastPublish = std::chrono::steady_clock::now();
+
+	logger::info("stats: publishing to {}", a_path.string());
+	return true;
+}
+
+void StatsExport::RecordFrame(std::chrono::nanoseconds a_cost)
+{
+	if (!_view)
+		return;
+
+	const auto ns = static_cast<std::uint64_t>(std::max(a_cost.count(), 0ll));
+	_frameNs += ns;
+	_counters.frames += 1;
+	_counters.frameUsMax = std::max(_counters.frameUsMax, static_cast<float>(ns) / 1000.f);
+
+	if (std::chrono::steady_clock::now() - _lastPublish >= 1s) {
+		Publish();
+	}
+}
+
+void StatsExport::RecordEvaluation(std::chrono::nanoseconds a_cost, std::uint32_t a_actors, std::uint32_t a_posedActors, std::uint32_t a_poseGroups,
+	std::uint32_t a_replacersLoaded, std::uint32_t a_replacersActive, std::uint32_t a_cacheHits, std::uint32_t a_cacheMisses)
+{
+	if (!_view)
+		return;
+
+	std::unique_lock lock{ _lock };
+	_evaluation.evaluationUs = std::chrono::duration<float, std::micro>(a_cost).count();
+	_evaluation.actors = a_actors;
+	_evaluation.posedActors = a_posedActors;
+	_evaluation.poseGroups = a_poseGroups;
+	_evaluation.replacersLoaded = a_replacersLoaded;
+	_evaluation.replacersActive = a_replacersActive;
+	_evaluation.cacheHits += a_cacheHits;
+	_evaluation.cacheMisses += a_cacheMisses;
+}
+
+void StatsExport::Publish()
+{
+	{
+		std::unique_lock lock{ _lock };
+		_counters.evaluationUs = _evaluation.evaluationUs;
+		_counters.actors = _evaluation.actors;
+		_counters.posedActors = _evaluation.posedActors;
+		_counters.poseGroups = _evaluation.poseGroups;
+		_counters.replacersLoaded = _evaluation.replacersLoaded;
+		_counters.replacersActive = _evaluation.replacersActive;
+		_counters.cacheHits = _evaluation.cacheHits;
+		_counters.cacheMisses = _evaluation.cacheMisses;
+	}
+
+	_counters.publishes += 1;
+	_counters.frameUsMean = _counters.frames ? static_cast<float>(_frameNs) / 1000.f / static_cast<float>(_counters.frames) : 0.f;
+	_counters.qualityLevel = std::to_underlying(ReplacerManager::GetQualityLevel());
+
+	_view->Write(_counters);
+
+	// the frame counters cover one period each
+	_frameNs = 0;
+	_counters.frames = 0;
+	_counters.frameUsMax = 0.f;
+	_lastPublish = std::chrono::steady_clock::now();
+}
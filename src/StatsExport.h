@@ -0,0 +1,36 @@
+#pragma once
+
+#include "StatsLayout.h"
+
+namespace PAR
+{
+	// Publishes live counters to a memory-mapped file once per second, read by tools/StatsReader
+	class StatsExport
+	{
+	public:
+		static bool Open(const fs::path& a_path);
+		static bool IsOpen() { return _view != nullptr; }
+
+		// main thread, publishes once a second has passed since the last publish
+		static void RecordFrame(std::chrono::nanoseconds a_cost);
+
+		// evaluation thread
+		static void RecordEvaluation(std::chrono::nanoseconds a_cost, std::uint32_t a_actors, std::uint32_t a_posedActors, std::uint32_t a_poseGroups,
+			std::uint32_t a_replacersLoaded, std::uint32_t a_replacersActive, std::uint32_t a_cacheHits, std::uint32_t a_cacheMisses);
+
+	private:
+		static void Publish();
+
+		// mapped for the lifetime of the process
+		static inline StatsLayout* _view = nullptr;
+
+		// only touched by the main thread
+		static inline StatsCounters _counters{};
+		static inline std::uint64_t _frameNs = 0;
+		static inline std::chrono::steady_clock::time_point _lastPublish;
+
+		// written by the evaluation thread, folded into _counters on publish
+		static inline std::mutex _lock;
+		static inline StatsCounters _evaluation{};
+	};
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Layout of the live stats file, shared by the plugin and tools/StatsReader
+// Bump VERSION on any change, readers refuse files of another version
+
+namespace PAR
+{
+	struct StatsCounters
+	{
+		std::uint64_t publishes;
+
+		// cumulative since the file was opened
+		std::uint64_t cacheHits;
+		std::uint64_t cacheMisses;
+
+		// cost of the frame hook over the last period
+		float frameUsMean;
+		float frameUsMax;
+		std::uint32_t frames;
+
+		// last evaluation pass
+		float evaluationUs;
+		std::uint32_t actors;
+		std::uint32_t posedActors;
+		std::uint32_t poseGroups;
+		std::uint32_t replacersLoaded;
+		std::uint32_t replacersActive;
+
+		std::uint32_t qualityLevel;
+	};
+
+	struct StatsLayout
+	{
+		static constexpr std::uint32_t MAGIC = 0x53524150;  // "PARS"
+		static constexpr std::uint32_t VERSION = 1;
+
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint32_t size;
+
+		// seqlock over counters, odd while the single writer is inside
+		std::atomic<std::uint32_t> sequence;
+
+		StatsCounters counters;
+
+		void Write(const StatsCounters& a_counters)
+		{
+			// the acquire half keeps the copy below from being hoisted above the odd value
+			const auto seq = sequence.fetch_add(1, std::memory_order_acq_rel);
+
+			std::memcpy(&counters, &a_counters, sizeof(StatsCounters));
+
+			sequence.store(seq + 2, std::memory_order_release);
+		}
+
+		// Starts a new session on a file a previous writer left, which may have stopped halfway through Write
+		void Reset()
+		{
+			// left odd, the next Write would look settled while it copies
+			if (sequence.load(std::memory_order_relaxed) & 1) {
+				sequence.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			Write(StatsCounters{});
+		}
+
+		// false if the writer was active, retry later
+		bool TryRead(StatsCounters& a_out) const
+		{
+			const auto before = sequence.load(std::memory_order_acquire);
+			if (before & 1)
+				return false;
+
+			std::memcpy(&a_out, &counters, sizeof(StatsCounters));
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return sequence.load(std::memory_order_relaxed) == before;
+		}
+	};
+
+	static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "the sequence is shared between processes");
+	static_assert(std::is_standard_layout_v<StatsLayout>);
+	static_assert(sizeof(StatsCounters) == 64 && sizeof(StatsLayout) == 80, "the layout is part of the file format");
+}
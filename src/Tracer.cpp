@@ -0,0 +1,201 @@
+#include "Tracer.h"
+
+#include <thread>
+
+using namespace PAR;
+
+namespace
+{
+	std::uint64_t Now()
+	{
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+}
+
+thread_local Tracer::LocalRing Tracer::_local;
+
+Tracer::Registry& Tracer::GetRegistry()
+{
+	// intentionally leaked, rings may outlive static destruction on exiting threads
+	static auto registry = new Registry();
+	return *registry;
+}
+
+Tracer::Ring* Tracer::GetLocal()
+{
+	const auto generation = _generation.load(std::memory_order_acquire);
+	if (!_local.ring || _local.generation != generation) {
+		auto& registry = GetRegistry();
+		std::unique_lock lock{ registry.lock };
+		if (registry.generation != generation || !IsEnabled()) {
+			return nullptr;
+		}
+
+		// reuse the ring of a thread that exited during this trace, the evaluation thread is a new one every pass
+		std::shared_ptr<Ring> ring;
+		if (!registry.free.empty()) {
+			ring = std::move(registry.free.back());
+			registry.free.pop_back();
+		} else {
+			ring = std::make_shared<Ring>();
+			registry.rings.push_back(ring);
+		}
+
+		ring->owners.push_back(Owner{ ring->head.load(std::memory_order_relaxed), GetCurrentThreadId(), _threadName });
+
+		_local.ring = std::move(ring);
+		_local.generation = generation;
+	}
+
+	return _local.ring.get();
+}
+
+Tracer::LocalRing::~LocalRing()
+{
+	if (!ring)
+		return;
+
+	auto& registry = GetRegistry();
+	std::unique_lock lock{ registry.lock };
+	if (registry.generation == generation) {
+		registry.free.push_back(std::move(ring));
+	}
+}
+
+void Tracer::SetThreadName(const char* a_name)
+{
+	_threadName = a_name;
+}
+
+void Tracer::Record(const char* a_name, char a_phase, std::uint32_t a_arg)
+{
+	if (!IsEnabled())
+		return;
+
+	const auto ring = GetLocal();
+	if (!ring)
+		return;
+
+	// either Stop sees the ring busy and waits, or this sees tracing stopped and backs off
+	ring->busy.store(true);
+	if (_enabled.load()) {
+		const auto head = ring->head.load(std::memory_order_relaxed);
+		ring->events[head & (RING_SIZE - 1)] = Event{ a_name, Now(), a_arg, a_phase };
+		ring->head.store(head + 1, std::memory_order_release);
+	}
+	ring->busy.store(false, std::memory_order_release);
+}
+
+void Tracer::Start()
+{
+	auto& registry = GetRegistry();
+	std::unique_lock lock{ registry.lock };
+
+	registry.rings.clear();
+	registry.free.clear();
+	registry.generation += 1;
+	_generation.store(registry.generation, std::memory_order_release);
+	_enabled = true;
+
+	logger::info("trace started");
+}
+
+bool Tracer::Stop(const std::string& a_name)
+{
+	_enabled = false;
+
+	std::vector<std::shared_ptr<Ring>> rings;
+	{
+		auto& registry = GetRegistry();
+		std::unique_lock lock{ registry.lock };
+		rings.swap(registry.rings);
+		registry.free.clear();
+		registry.generation += 1;
+		_generation.store(registry.generation, std::memory_order_release);
+	}
+
+	// writers that saw tracing enabled finish their event, later ones back off
+	for (const auto& ring : rings) {
+		while (ring->busy.load()) {
+			std::this_thread::yield();
+		}
+	}
+
+	const auto stop = Now();
+
+	auto path = logger::log_directory();
+	if (!path) {
+		return false;
+	}
+
+	*path /= a_name.ends_with(".json") ? a_name : a_name + ".json";
+
+	std::ofstream file{ *path };
+	if (!file.is_open()) {
+		logger::error("failed to open trace file {}", path->string());
+		return false;
+	}
+
+	file << "{\"traceEvents\":[";
+	std::size_t written = 0;
+	for (const auto& ring : rings) {
+		Write(file, *ring, stop, written);
+	}
+	file << "]}";
+
+	logger::info("trace written to {}", path->string());
+	return true;
+}
+
+// One segment per owner of the ring, scopes still open when a segment ends are closed at its end,
+// ends whose begin was overwritten are dropped
+void Tracer::Write(std::ofstream& a_file, const Ring& a_ring, std::uint64_t a_stop, std::size_t& a_written)
+{
+	const auto pid = GetCurrentProcessId();
+
+	const auto head = a_ring.head.load(std::memory_order_acquire);
+	const auto first = head > RING_SIZE ? head - RING_SIZE : 0;
+
+	const auto& owners = a_ring.owners;
+	for (std::size_t k = 0; k < owners.size(); ++k) {
+		const auto& owner = owners[k];
+		const bool last = k + 1 == owners.size();
+
+		const auto begin = std::max(owner.start, first);
+		const auto end = last ? head : owners[k + 1].start;
+		if (begin >= end)
+			continue;
+
+		const auto separator = a_written++ ? "," : "";
+		a_file << std::format(R"({}{{"name":"thread_name","ph":"M","pid":{},"tid":{},"args":{{"name":"{}"}}}})",
+			separator, pid, owner.tid, owner.threadName ? owner.threadName : "thread");
+
+		const auto write = [&](const char* a_name, char a_phase, std::uint64_t a_ts, std::uint32_t a_arg) {
+			a_file << std::format(R"(,{{"name":"{}","ph":"{}","ts":{:.3f},"pid":{},"tid":{},"args":{{"arg":"{:x}"}}}})",
+				a_name, a_phase, static_cast<double>(a_ts) / 1000.0, pid, owner.tid, a_arg);
+		};
+
+		std::vector<const Event*> open;
+		std::uint64_t ts = 0;
+
+		for (auto i = begin; i < end; ++i) {
+			const auto& event = a_ring.events[i & (RING_SIZE - 1)];
+			if (event.phase == 'B') {
+				open.push_back(std::addressof(event));
+			} else if (event.phase == 'E') {
+				if (open.empty())
+					continue;
+				open.pop_back();
+			}
+
+			write(event.name, event.phase, event.ts, event.arg);
+			ts = event.ts;
+		}
+
+		// the owner is still inside these scopes, or exited before they were recorded as ended
+		const auto close = last ? a_stop : ts;
+		for (auto iter = open.rbegin(); iter != open.rend(); ++iter) {
+			write((*iter)->name, 'E', close, (*iter)->arg);
+		}
+	}
+}
\ No newline at end of file
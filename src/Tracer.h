@@ -0,0 +1,107 @@
+#pragma once
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(...) PAR::Tracer::Scope TRACE_CONCAT(_traceScope, __LINE__){ __VA_ARGS__ }
+
+namespace PAR
+{
+	// Opt-in timeline capture, exported in the chrome trace_event format
+	class Tracer
+	{
+	public:
+		static constexpr std::size_t RING_SIZE = 1 << 15;
+
+		struct Event
+		{
+			const char* name;
+			std::uint64_t ts;
+			std::uint32_t arg;
+			char phase;
+		};
+
+		class Scope
+		{
+		public:
+			explicit Scope(const char* a_name, std::uint32_t a_arg = 0) :
+				_name(a_name), _arg(a_arg), _active(IsEnabled())
+			{
+				if (_active) {
+					Record(_name, 'B', _arg);
+				}
+			}
+
+			~Scope()
+			{
+				if (_active) {
+					Record(_name, 'E', _arg);
+				}
+			}
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			const char* _name;
+			std::uint32_t _arg;
+			bool _active;
+		};
+
+		static void Start();
+		static bool Stop(const std::string& a_name);
+
+		static bool IsEnabled() { return _enabled.load(std::memory_order_relaxed); }
+		static void SetThreadName(const char* a_name);
+
+		static void Record(const char* a_name, char a_phase, std::uint32_t a_arg);
+
+	private:
+		// a thread that wrote events from position start on
+		struct Owner
+		{
+			std::uint64_t start;
+			std::uint32_t tid;
+			const char* threadName;
+		};
+
+		// single producer ring, handed to the next new thread once its owner exits, read back once every writer left it
+		struct Ring
+		{
+			std::unique_ptr<Event[]> events{ std::make_unique<Event[]>(RING_SIZE) };
+			std::atomic<std::uint64_t> head = 0;
+
+			// set while a Record may write into the ring, Stop waits for it to clear
+			std::atomic<bool> busy = false;
+
+			// guarded by the registry lock
+			std::vector<Owner> owners;
+		};
+
+		struct Registry
+		{
+			std::mutex lock;
+			std::vector<std::shared_ptr<Ring>> rings;
+			std::vector<std::shared_ptr<Ring>> free;
+			std::uint32_t generation = 0;
+		};
+
+		// returns the ring of an exiting thread to the registry
+		struct LocalRing
+		{
+			std::shared_ptr<Ring> ring;
+			std::uint32_t generation = 0;
+
+			~LocalRing();
+		};
+
+		static Registry& GetRegistry();
+		static Ring* GetLocal();
+		static void Write(std::ofstream& a_file, const Ring& a_ring, std::uint64_t a_stop, std::size_t& a_written);
+
+		static thread_local LocalRing _local;
+		static inline thread_local const char* _threadName = nullptr;
+
+		static inline std::atomic<bool> _enabled = false;
+		static inline std::atomic<std::uint32_t> _generation = 0;
+	};
+}
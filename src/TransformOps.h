@@ -0,0 +1,88 @@
+#pragma once
+
+#include "FastMath.h"
+
+#include <cmath>
+#include <cstdint>
+
+// What overrides and limits do to one bone, free of game types so tools/Tests runs the interpreter and the kernels'
+// plan on stand-ins for NiTransform: anything with rotate.entry[3][3], translate[3] and scale
+
+namespace PAR
+{
+	enum Channel : std::uint8_t
+	{
+		kRotate = 1 << 0,
+		kTranslate = 1 << 1,
+		kScale = 1 << 2
+	};
+}
+
+namespace PAR::TransformOps
+{
+	// a degenerate range leaves the value as it is
+	inline float Saturate(float x, float lo, float hi)
+	{
+		if (lo >= hi)  // do nothing
+			return x;
+		const float s = (hi - lo) / 2;
+		const float m = (hi + lo) / 2;
+		return m + s * std::tanh((x - m) / s);
+	}
+
+	template <class Limit>
+	bool HasRotationRange(const Limit& a_limit)
+	{
+		for (int axis = 0; axis < 3; ++axis) {
+			if (a_limit.rotate_low[axis] < a_limit.rotate_high[axis])
+				return true;
+		}
+		return false;
+	}
+
+	// Without any rotation range the matrix isn't touched: near gimbal lock the Euler round trip drops y,
+	// a limit that only bounds translation or scale must not change the rotation
+	template <class Limit>
+	void SaturateRotation(float (&a_rotate)[3][3], const Limit& a_limit)
+	{
+		if (!HasRotationRange(a_limit))
+			return;
+
+		float eulers[3];
+		FastMath::MatToEulerYXZ(a_rotate, eulers);
+		for (int axis = 0; axis < 3; ++axis) {
+			eulers[axis] = Saturate(eulers[axis], a_limit.rotate_low[axis], a_limit.rotate_high[axis]);
+		}
+		FastMath::EulerYXZToMat(a_rotate, eulers);
+	}
+
+	template <class Transform, class Override>
+	void ApplyOverride(Transform& a_transform, const Override& a_override)
+	{
+		if (a_override.channels & kRotate) {
+			a_transform.rotate = a_override.transform.rotate;
+		}
+		if (a_override.channels & kTranslate) {
+			a_transform.translate = a_override.transform.translate;
+		}
+		if (a_override.channels & kScale) {
+			a_transform.scale = a_override.transform.scale;
+		}
+	}
+
+	template <class Transform, class Limit>
+	void ApplyLimit(Transform& a_transform, const Limit& a_limit, std::uint8_t a_channels)
+	{
+		if (a_channels & kRotate) {
+			SaturateRotation(a_transform.rotate.entry, a_limit);
+		}
+		if (a_channels & kTranslate) {
+			for (int i = 0; i < 3; ++i) {
+				a_transform.translate[i] = Saturate(a_transform.translate[i], a_limit.translate_low[i], a_limit.translate_high[i]);
+			}
+		}
+		if (a_channels & kScale) {
+			a_transform.scale = Saturate(a_transform.scale, a_limit.scale_low, a_limit.scale_high);
+		}
+	}
+}
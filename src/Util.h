@@ -1,5 +1,7 @@
 #pragma once
 
+#include <Psapi.h>
+
 namespace PAR::Util
 {
 	using SKSE::stl::enumeration;
@@ -73,4 +75,22 @@ namespace PAR::Util
 
 		return RE::TESDataHandler::GetSingleton()->LookupForm<T>(formId, splits[1]);
 	}
+
+	inline std::size_t GetResidentMemory()
+	{
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			return counters.WorkingSetSize;
+		}
+		return 0;
+	}
+
+	inline std::size_t GetPeakResidentMemory()
+	{
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			return counters.PeakWorkingSetSize;
+		}
+		return 0;
+	}
 }
\ No newline at end of file
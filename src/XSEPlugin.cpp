@@ -1,6 +1,7 @@
 #include "Hooks.h"
 #include "Papyrus.h"
 #include "ReplacerManager.h"
+#include "Settings.h"
 
 using namespace PAR;
 
@@ -42,6 +43,8 @@ extern "C" DLLEXPORT bool SKSEAPI SKSEPlugin_Load(const SKSE::LoadInterface* a_s
 	logger::info("Loaded plugin {} {}", Plugin::NAME, Plugin::VERSION.string());
 	SKSE::Init(a_skse);
 
+	Settings::Load();
+
 	Hooks::Install();
 
 	if (const auto messaging{ SKSE::GetMessagingInterface() }; !messaging->RegisterListener(Listener))
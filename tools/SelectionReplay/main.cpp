@@ -0,0 +1,273 @@
+// Feeds a recording made with StartRecording/StopRecording back through the plugin's selection code
+// Checks that every pass selects what the game selected, then measures selection throughput
+// usage: PARSelectionReplay <recording> [--repeat N]
+
+#include "RecordingFormat.h"
+#include "Selection.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace PAR;
+
+namespace
+{
+	struct Generation
+	{
+		std::uint64_t version = 0;
+		std::vector<std::string> names;
+		std::vector<BoneSet> bones;
+		std::vector<BoneSet> coverage;
+		std::vector<std::uint32_t> unindexed;
+		std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> raceIndex;
+	};
+
+	struct Actor
+	{
+		std::uint32_t id = 0;
+		std::uint32_t race = 0;
+		std::uint8_t flags = 0;
+		std::vector<bool> outcomes;
+		std::vector<std::uint32_t> selected;
+	};
+
+	struct Pass
+	{
+		std::size_t generation = 0;
+		std::uint64_t selectionNs = 0;
+		std::vector<Actor> actors;
+	};
+
+	struct Session
+	{
+		std::vector<Generation> generations;
+		std::vector<Pass> passes;
+	};
+
+	bool ReadIndices(Recording::Reader& a_reader, std::size_t a_count, std::size_t a_bound, std::vector<std::uint32_t>& a_out)
+	{
+		a_out.resize(a_count);
+		for (auto& index : a_out) {
+			index = a_reader.Get<std::uint32_t>();
+			if (index >= a_bound)
+				return false;
+		}
+		return a_reader.Ok();
+	}
+
+	bool ReadGeneration(Recording::Reader& a_reader, Generation& a_generation)
+	{
+		a_generation.version = a_reader.Get<std::uint64_t>();
+
+		const auto count = a_reader.Get<std::uint32_t>();
+		for (std::uint32_t i = 0; i < count && a_reader.Ok(); ++i) {
+			a_generation.names.push_back(a_reader.GetString());
+
+			auto& bones = a_generation.bones.emplace_back();
+			const auto boneCount = a_reader.Get<std::uint16_t>();
+			for (std::uint16_t k = 0; k < boneCount; ++k) {
+				bones.Insert(a_reader.Get<BoneID>());
+			}
+		}
+
+		if (!ReadIndices(a_reader, a_reader.Get<std::uint32_t>(), count, a_generation.unindexed))
+			return false;
+
+		const auto races = a_reader.Get<std::uint32_t>();
+		for (std::uint32_t i = 0; i < races && a_reader.Ok(); ++i) {
+			const auto race = a_reader.Get<std::uint32_t>();
+			if (!ReadIndices(a_reader, a_reader.Get<std::uint32_t>(), count, a_generation.raceIndex[race]))
+				return false;
+		}
+
+		Selection::BuildCoverage(a_generation.bones.size(), [&](std::size_t a_index) -> const BoneSet& {
+			return a_generation.bones[a_index];
+		}, a_generation.coverage);
+
+		return a_reader.Ok();
+	}
+
+	bool ReadPass(Recording::Reader& a_reader, const Generation& a_generation, Pass& a_pass)
+	{
+		a_pass.selectionNs = a_reader.Get<std::uint64_t>();
+
+		const auto count = a_reader.Get<std::uint32_t>();
+		for (std::uint32_t i = 0; i < count && a_reader.Ok(); ++i) {
+			auto& actor = a_pass.actors.emplace_back();
+			actor.id = a_reader.Get<std::uint32_t>();
+			actor.race = a_reader.Get<std::uint32_t>();
+			actor.flags = a_reader.Get<std::uint8_t>();
+			a_reader.GetBits(actor.outcomes);
+
+			if (!ReadIndices(a_reader, a_reader.Get<std::uint16_t>(), a_generation.names.size(), actor.selected))
+				return false;
+		}
+
+		return a_reader.Ok();
+	}
+
+	bool Load(const char* a_path, Session& a_session)
+	{
+		std::ifstream file{ a_path, std::ios::binary };
+		if (!file.is_open()) {
+			std::fprintf(stderr, "%s: cannot open\n", a_path);
+			return false;
+		}
+
+		const std::vector<std::uint8_t> bytes{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+		Recording::Reader reader{ bytes.data(), bytes.size() };
+
+		if (reader.Get<std::uint32_t>() != Recording::MAGIC || reader.Get<std::uint32_t>() != Recording::VERSION) {
+			std::fprintf(stderr, "%s: not a recording of version %u\n", a_path, Recording::VERSION);
+			return false;
+		}
+
+		while (!reader.AtEnd()) {
+			const auto tag = reader.Get<Recording::Tag>();
+			bool ok = false;
+
+			if (tag == Recording::Tag::kGeneration) {
+				ok = ReadGeneration(reader, a_session.generations.emplace_back());
+			} else if (tag == Recording::Tag::kPass && !a_session.generations.empty()) {
+				auto& pass = a_session.passes.emplace_back();
+				pass.generation = a_session.generations.size() - 1;
+				ok = ReadPass(reader, a_session.generations.back(), pass);
+			}
+
+			if (!ok) {
+				// a recording cut off by a crash still replays up to its last complete pass
+				std::fprintf(stderr, "%s: stopped at a malformed or truncated record\n", a_path);
+				if (tag == Recording::Tag::kPass) {
+					a_session.passes.pop_back();
+				}
+				break;
+			}
+		}
+
+		return true;
+	}
+
+	// false if selection asked for other outcomes than the game did
+	bool Replay(const Generation& a_generation, const Actor& a_actor, std::vector<std::uint32_t>& a_candidates, std::vector<std::uint32_t>& a_selected)
+	{
+		const auto race = a_generation.raceIndex.find(a_actor.race);
+
+		a_candidates.clear();
+		Selection::MergeCandidates(a_generation.unindexed, race != a_generation.raceIndex.end() ? &race->second : nullptr, a_candidates);
+
+		std::size_t next = 0;
+		bool diverged = false;
+
+		a_selected.clear();
+		Selection::Select(
+			a_candidates,
+			a_generation.coverage,
+			[&](std::uint32_t a_index) -> const BoneSet& {
+				return a_generation.bones[a_index];
+			},
+			[&](std::uint32_t) {
+				if (next == a_actor.outcomes.size()) {
+					diverged = true;
+					return false;
+				}
+				return static_cast<bool>(a_actor.outcomes[next++]);
+			},
+			[&](std::uint32_t a_index) {
+				a_selected.push_back(a_index);
+			});
+
+		return !diverged && next == a_actor.outcomes.size();
+	}
+
+	void PrintSelection(const char* a_label, const Generation& a_generation, const std::vector<std::uint32_t>& a_selection)
+	{
+		std::printf("    %s:", a_label);
+		for (const auto index : a_selection) {
+			std::printf(" %s", a_generation.names[index].c_str());
+		}
+		std::printf("\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		std::fprintf(stderr, "usage: %s <recording> [--repeat N]\n", argv[0]);
+		return 2;
+	}
+
+	int repeat = 100;
+	if (argc > 3 && std::string_view{ argv[2] } == "--repeat") {
+		repeat = std::max(1, std::atoi(argv[3]));
+	}
+
+	Session session;
+	if (!Load(argv[1], session))
+		return 1;
+
+	std::size_t actors = 0;
+	std::size_t cacheHits = 0;
+	std::size_t mismatches = 0;
+	std::uint64_t liveNs = 0;
+
+	std::vector<std::uint32_t> candidates;
+	std::vector<std::uint32_t> selected;
+
+	for (std::size_t p = 0; p < session.passes.size(); ++p) {
+		const auto& pass = session.passes[p];
+		const auto& generation = session.generations[pass.generation];
+		liveNs += pass.selectionNs;
+
+		for (const auto& actor : pass.actors) {
+			actors += 1;
+			if (actor.flags & Recording::kCacheHit) {
+				cacheHits += 1;
+				continue;
+			}
+
+			const bool consistent = Replay(generation, actor, candidates, selected);
+			if (consistent && selected == actor.selected)
+				continue;
+
+			mismatches += 1;
+			if (mismatches <= 10) {
+				std::printf("mismatch in pass %zu for actor %08X%s\n", p, actor.id, consistent ? "" : ", outcomes consumed differently");
+				PrintSelection("recorded", generation, actor.selected);
+				PrintSelection("replayed", generation, selected);
+			}
+		}
+	}
+
+	std::printf("%zu generations, %zu passes, %zu actors (%zu cache hits not replayed), %zu mismatches\n",
+		session.generations.size(), session.passes.size(), actors, cacheHits, mismatches);
+
+	const auto replayed = actors - cacheHits;
+	if (replayed == 0)
+		return mismatches ? 1 : 0;
+
+	// outcomes are looked up instead of evaluated, what is left is candidate merging, coverage and bone conflicts
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < repeat; ++i) {
+		for (const auto& pass : session.passes) {
+			const auto& generation = session.generations[pass.generation];
+			for (const auto& actor : pass.actors) {
+				if (!(actor.flags & Recording::kCacheHit)) {
+					Replay(generation, actor, candidates, selected);
+				}
+			}
+		}
+	}
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	const auto perActor = elapsed / static_cast<double>(replayed) / repeat;
+	std::printf("replay: %.0f selections/s, %.1f ns per selection over %d repeats\n", 1e9 / perActor, perActor, repeat);
+	std::printf("live: %.1f ns per actor including condition evaluation and cache hits\n", static_cast<double>(liveNs) / static_cast<double>(actors));
+
+	return mismatches ? 1 : 0;
+}
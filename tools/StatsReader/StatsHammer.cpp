@@ -0,0 +1,199 @@
+// Hammers the seqlock of the stats file: a writer publishes as fast as it can while readers map the same file,
+// no read may be accepted with counters of two different publishes, also across a writer reopening the file
+// usage: PARStatsHammer [file], a file in the temp directory by default
+
+#include "StatsLayout.h"
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <new>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	include <Windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+using namespace PAR;
+
+namespace
+{
+	// opens the file like StatsExport::Open, existing files are reused and only grown
+	void* Map(const std::filesystem::path& a_path, bool a_write)
+	{
+#ifdef _WIN32
+		const auto file = CreateFileW(a_path.c_str(), GENERIC_READ | (a_write ? GENERIC_WRITE : 0), FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+			a_write ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return nullptr;
+
+		const auto mapping = CreateFileMappingW(file, nullptr, a_write ? PAGE_READWRITE : PAGE_READONLY, 0, sizeof(StatsLayout), nullptr);
+		CloseHandle(file);
+		if (!mapping)
+			return nullptr;
+
+		const auto view = MapViewOfFile(mapping, a_write ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, sizeof(StatsLayout));
+		CloseHandle(mapping);
+		return view;
+#else
+		const auto file = open(a_path.c_str(), a_write ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+		if (file < 0)
+			return nullptr;
+
+		struct stat info{};
+		void* view = MAP_FAILED;
+		if (fstat(file, &info) == 0 && (info.st_size >= static_cast<off_t>(sizeof(StatsLayout)) || (a_write && ftruncate(file, sizeof(StatsLayout)) == 0))) {
+			view = mmap(nullptr, sizeof(StatsLayout), a_write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file, 0);
+		}
+		close(file);
+		return view != MAP_FAILED ? view : nullptr;
+#endif
+	}
+
+	void Unmap(const void* a_view)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(a_view);
+#else
+		munmap(const_cast<void*>(a_view), sizeof(StatsLayout));
+#endif
+	}
+
+	// the same steps as StatsExport::Open once the view is mapped
+	StatsLayout* Begin(void* a_view)
+	{
+		auto layout = static_cast<StatsLayout*>(a_view);
+		if (std::atomic_ref{ layout->magic }.load(std::memory_order_acquire) == StatsLayout::MAGIC && layout->version == StatsLayout::VERSION) {
+			layout->Reset();
+		} else {
+			layout = new (a_view) StatsLayout{};
+			layout->version = StatsLayout::VERSION;
+			layout->size = sizeof(StatsLayout);
+			std::atomic_ref{ layout->magic }.store(StatsLayout::MAGIC, std::memory_order_release);
+		}
+		return layout;
+	}
+
+	// every field derives from publishes and the session, a torn read breaks the relation
+	StatsCounters Make(std::uint64_t a_publishes, std::uint32_t a_session)
+	{
+		StatsCounters counters{};
+		counters.publishes = a_publishes;
+		counters.cacheHits = a_publishes * 7;
+		counters.cacheMisses = a_publishes ^ 0x5555;
+		counters.frames = static_cast<std::uint32_t>(a_publishes * 3);
+		counters.actors = static_cast<std::uint32_t>(a_publishes % 1000);
+		counters.poseGroups = counters.actors + a_session;
+		counters.qualityLevel = a_session;
+		return counters;
+	}
+
+	bool Consistent(const StatsCounters& a_counters)
+	{
+		if (a_counters.publishes == 0) {
+			// Reset's empty counters
+			return a_counters.cacheHits == 0 && a_counters.actors == 0 && a_counters.poseGroups == 0;
+		}
+
+		const auto expected = Make(a_counters.publishes, a_counters.qualityLevel);
+		return a_counters.cacheHits == expected.cacheHits && a_counters.cacheMisses == expected.cacheMisses &&
+		       a_counters.frames == expected.frames && a_counters.actors == expected.actors && a_counters.poseGroups == expected.poseGroups;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	constexpr std::uint64_t PUBLISHES = 2000000;
+	constexpr std::uint32_t SESSIONS = 3;
+	constexpr int READERS = 2;
+
+	const std::filesystem::path path = argc > 1 ? std::filesystem::path{ argv[1] } : std::filesystem::temp_directory_path() / "PARStatsHammer.stats";
+	std::filesystem::remove(path);
+
+	auto view = Map(path, true);
+	if (!view) {
+		std::printf("failed to create %s\n", path.string().c_str());
+		return 1;
+	}
+	auto layout = Begin(view);
+
+	std::atomic<bool> done = false;
+	std::atomic<std::uint64_t> accepted = 0;
+	std::atomic<std::uint64_t> retried = 0;
+	std::atomic<std::uint64_t> torn = 0;
+
+	// the readers map the file once and keep it mapped while the writer reopens it
+	std::vector<std::thread> readers;
+	for (int i = 0; i < READERS; ++i) {
+		readers.emplace_back([&]() {
+			const auto reader = static_cast<const StatsLayout*>(Map(path, false));
+			if (!reader) {
+				torn += 1;
+				return;
+			}
+
+			while (!done.load()) {
+				StatsCounters counters;
+				if (!reader->TryRead(counters)) {
+					retried += 1;
+				} else if (Consistent(counters)) {
+					accepted += 1;
+				} else {
+					torn += 1;
+				}
+			}
+
+			Unmap(reader);
+		});
+	}
+
+	for (std::uint32_t session = 1; session <= SESSIONS; ++session) {
+		if (session > 1) {
+			// a new game session opening the file the readers still have mapped
+			Unmap(view);
+			view = Map(path, true);
+			if (!view) {
+				std::printf("failed to reopen %s while it is mapped\n", path.string().c_str());
+				done = true;
+				for (auto& reader : readers) {
+					reader.join();
+				}
+				return 1;
+			}
+			layout = Begin(view);
+		}
+
+		for (std::uint64_t publishes = 1; publishes <= PUBLISHES; ++publishes) {
+			layout->Write(Make(publishes, session));
+		}
+	}
+
+	done = true;
+	for (auto& reader : readers) {
+		reader.join();
+	}
+
+	StatsCounters last;
+	const bool settled = layout->TryRead(last);
+
+	Unmap(view);
+	std::filesystem::remove(path);
+
+	std::printf("accepted %llu, retried %llu, torn %llu\n", static_cast<unsigned long long>(accepted.load()),
+		static_cast<unsigned long long>(retried.load()), static_cast<unsigned long long>(torn.load()));
+
+	if (torn || !accepted || !settled || last.publishes != PUBLISHES || last.qualityLevel != SESSIONS) {
+		std::printf("seqlock check failed\n");
+		return 1;
+	}
+
+	std::printf("seqlock check passed\n");
+	return 0;
+}
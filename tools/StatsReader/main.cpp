@@ -0,0 +1,114 @@
+// Prints the live counters the plugin publishes to its stats file (see sStatsFile in the ini)
+// usage: PARStatsReader <file> [--once]
+
+#include "StatsLayout.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+#include <thread>
+
+#ifdef _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	include <Windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+using namespace PAR;
+
+namespace
+{
+	// read-only view of the whole layout, null until the plugin created the file
+	const StatsLayout* Map(const char* a_path)
+	{
+#ifdef _WIN32
+		const auto file = CreateFileA(a_path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return nullptr;
+
+		LARGE_INTEGER size{};
+		const auto mapping = GetFileSizeEx(file, &size) && size.QuadPart >= static_cast<LONGLONG>(sizeof(StatsLayout)) ?
+		                         CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, sizeof(StatsLayout), nullptr) :
+		                         nullptr;
+		CloseHandle(file);
+		if (!mapping)
+			return nullptr;
+
+		const auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(StatsLayout));
+		CloseHandle(mapping);
+		return static_cast<const StatsLayout*>(view);
+#else
+		const auto file = open(a_path, O_RDONLY);
+		if (file < 0)
+			return nullptr;
+
+		struct stat info{};
+		void* view = MAP_FAILED;
+		if (fstat(file, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(StatsLayout))) {
+			view = mmap(nullptr, sizeof(StatsLayout), PROT_READ, MAP_SHARED, file, 0);
+		}
+		close(file);
+		return view != MAP_FAILED ? static_cast<const StatsLayout*>(view) : nullptr;
+#endif
+	}
+
+	void Print(const StatsCounters& a_counters)
+	{
+		const auto lookups = a_counters.cacheHits + a_counters.cacheMisses;
+		const auto hitRate = lookups ? 100.0 * static_cast<double>(a_counters.cacheHits) / static_cast<double>(lookups) : 0.0;
+
+		std::printf("#%llu frame %.1fus (max %.1fus, %u frames) | eval %.1fus, %u actors, %u posed in %u poses | replacers %u/%u active | cache %.1f%% | quality %u\n",
+			static_cast<unsigned long long>(a_counters.publishes),
+			a_counters.frameUsMean,
+			a_counters.frameUsMax,
+			a_counters.frames,
+			a_counters.evaluationUs,
+			a_counters.actors,
+			a_counters.posedActors,
+			a_counters.poseGroups,
+			a_counters.replacersActive,
+			a_counters.replacersLoaded,
+			hitRate,
+			a_counters.qualityLevel);
+		std::fflush(stdout);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		std::fprintf(stderr, "usage: %s <stats file> [--once]\n", argv[0]);
+		return 2;
+	}
+
+	const bool once = argc > 2 && std::string_view{ argv[2] } == "--once";
+
+	const auto layout = Map(argv[1]);
+	if (!layout) {
+		std::fprintf(stderr, "%s: not found or too small, is sStatsFile set?\n", argv[1]);
+		return 1;
+	}
+
+	if (std::atomic_ref{ const_cast<std::uint32_t&>(layout->magic) }.load(std::memory_order_acquire) != StatsLayout::MAGIC || layout->version != StatsLayout::VERSION) {
+		std::fprintf(stderr, "%s: not a stats file of version %u\n", argv[1], StatsLayout::VERSION);
+		return 1;
+	}
+
+	std::uint64_t last = 0;
+	while (true) {
+		StatsCounters counters;
+		if (layout->TryRead(counters) && counters.publishes != last) {
+			last = counters.publishes;
+			Print(counters);
+
+			if (once)
+				return 0;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+}
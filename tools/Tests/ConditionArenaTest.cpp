@@ -0,0 +1,207 @@
+// Condition arenas over stand-ins for TESCondition, and a reload loop that must keep the live allocations flat
+
+#include "ConditionArena.h"
+#include "Harness.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace PAR;
+
+namespace
+{
+	std::atomic<std::int64_t> liveAllocations = 0;
+}
+
+// counts every allocation that is still alive, the standard library included
+// GCC flags the free of a pointer it saw come from operator new once both are inlined, they pair up here
+#if defined(__GNUC__) && !defined(__clang__)
+#	pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t a_size)
+{
+	if (auto ptr = std::malloc(a_size ? a_size : 1)) {
+		liveAllocations.fetch_add(1, std::memory_order_relaxed);
+		return ptr;
+	}
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* a_ptr) noexcept
+{
+	if (a_ptr) {
+		liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+		std::free(a_ptr);
+	}
+}
+
+void operator delete(void* a_ptr, std::size_t) noexcept
+{
+	operator delete(a_ptr);
+}
+
+namespace
+{
+	struct Item
+	{
+		std::uint32_t data = 0;
+		Item* next = nullptr;
+	};
+
+	// like TESCondition it frees the chain it heads
+	struct Condition
+	{
+		Item* head = nullptr;
+
+		~Condition()
+		{
+			while (head) {
+				delete std::exchange(head, head->next);
+			}
+		}
+	};
+
+	using Arena = ConditionArena<Condition, Item>;
+
+	bool Parse(const std::string& a_text, Item& a_item)
+	{
+		if (a_text == "bad")
+			return false;
+
+		a_item.data = static_cast<std::uint32_t>(a_text.size());
+		return true;
+	}
+
+	std::size_t Length(const Condition& a_condition)
+	{
+		std::size_t length = 0;
+		for (auto item = a_condition.head; item; item = item->next) {
+			length += 1;
+		}
+		return length;
+	}
+
+	void Chain()
+	{
+		const std::vector<std::string> texts{ "a", "", "bb", "ccc", "" };
+
+		const auto condition = Arena::Build(texts, Parse);
+		CHECK(condition);
+		CHECK(Length(*condition) == 3);
+
+		// one block, in the order of the texts
+		const auto head = condition->head;
+		CHECK(head->data == 1 && head->next == head + 1);
+		CHECK(head[1].data == 2 && head[1].next == head + 2);
+		CHECK(head[2].data == 3 && head[2].next == nullptr);
+	}
+
+	void Rejected()
+	{
+		const auto before = liveAllocations.load();
+
+		CHECK(!Arena::Build(std::vector<std::string>{ "a", "bad", "c" }, Parse));
+		CHECK(!Arena::Build(std::vector<std::string>{ "", "" }, Parse));
+		CHECK(!Arena::Build(std::vector<std::string>{}, Parse));
+
+		CHECK(liveAllocations.load() == before);
+	}
+
+	// stands in for a replacer, only its condition is allocated per load
+	struct Replacer
+	{
+		std::shared_ptr<Condition> conditions;
+	};
+
+	using Generation = std::map<std::string, std::shared_ptr<const Replacer>>;
+
+	std::shared_ptr<const Replacer> Load(std::size_t a_version)
+	{
+		std::vector<std::string> texts;
+		for (std::size_t i = 0; i < 16; ++i) {
+			texts.push_back("IsInCombat == " + std::to_string((a_version + i) % 2));
+		}
+		return std::make_shared<const Replacer>(Replacer{ Arena::Build(texts, Parse) });
+	}
+
+	// ReloadFile: a new generation shares the unchanged replacers and replaces the reloaded one, while an
+	// evaluation thread keeps pinning generations and walking the chains
+	void ReloadLoop()
+	{
+		constexpr std::size_t FILES = 32;
+		constexpr std::size_t RELOADS = 20000;
+		constexpr std::size_t WARMUP = 1000;
+
+		std::atomic<std::shared_ptr<const Generation>> current;
+		{
+			auto generation = std::make_shared<Generation>();
+			for (std::size_t i = 0; i < FILES; ++i) {
+				(*generation)["file" + std::to_string(i)] = Load(i);
+			}
+			current.store(std::move(generation));
+		}
+
+		std::atomic<bool> done = false;
+		std::atomic<std::size_t> walked = 0;
+		std::thread evaluation([&]() {
+			while (!done.load()) {
+				const auto generation = current.load();
+				for (const auto& [name, replacer] : *generation) {
+					walked += Length(*replacer->conditions) == 16 ? 1 : 0;
+				}
+			}
+		});
+
+		std::int64_t baseline = 0;
+		std::int64_t peak = 0;
+
+		for (std::size_t reload = 0; reload < RELOADS; ++reload) {
+			auto generation = std::make_shared<Generation>(*current.load());
+			(*generation)["file" + std::to_string(reload % FILES)] = Load(reload);
+			current.store(std::move(generation));
+
+			if (reload == WARMUP) {
+				baseline = liveAllocations.load();
+			} else if (reload > WARMUP) {
+				peak = std::max(peak, liveAllocations.load());
+			}
+		}
+
+		done.store(true);
+		evaluation.join();
+
+		const auto end = liveAllocations.load();
+		std::printf("live allocations after warmup %lld, peak %lld, at end %lld\n",
+			static_cast<long long>(baseline), static_cast<long long>(peak), static_cast<long long>(end));
+
+		// a leaked condition per reload would add thousands, the slack only covers generations pinned by the evaluation
+		CHECK(end <= baseline + 8);
+		CHECK(peak <= baseline + 128);
+		CHECK(walked > 0);
+
+		current.store(nullptr);
+	}
+}
+
+int main()
+{
+	Chain();
+	Rejected();
+
+	const auto before = liveAllocations.load();
+	ReloadLoop();
+	CHECK(liveAllocations.load() <= before + 8);
+
+	return Harness::Result();
+}
@@ -0,0 +1,571 @@
+// Headless crowd run over the game-free parts of the pipeline: 500 replacer files are written as json and loaded with
+// their conditions checked by ConditionSyntax, then 100 actors of 60 bones are selected with Selection and posed every frame
+// A fake clock steps the frames and the evaluation timer like Hooks::UpdatePlayer, so every run does the same work
+// Fails when the load, a frame or an evaluation costs more than its threshold, or when a frame allocates more than it may
+// usage: CrowdBenchmark [--no-time-limits]
+
+#include "ConditionSyntax.h"
+#include "FastMath.h"
+#include "Harness.h"
+#include "Selection.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+using namespace PAR;
+
+namespace
+{
+	std::atomic<std::int64_t> allocations = 0;
+}
+
+// counts every allocation, the standard library included
+// GCC flags the free of a pointer it saw come from operator new once both are inlined, they pair up here
+#if defined(__GNUC__) && !defined(__clang__)
+#	pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t a_size)
+{
+	if (auto ptr = std::malloc(a_size ? a_size : 1)) {
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		return ptr;
+	}
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* a_ptr) noexcept
+{
+	std::free(a_ptr);
+}
+
+void operator delete(void* a_ptr, std::size_t) noexcept
+{
+	std::free(a_ptr);
+}
+
+namespace
+{
+	constexpr std::size_t FILES = 500;
+	constexpr std::size_t ACTORS = 100;
+	constexpr std::size_t BONES = 60;
+	constexpr std::uint32_t RACES = 4;
+
+	// ten seconds at 60 fps, evaluated once a second like Hooks::UpdatePlayer
+	constexpr int FRAMES = 600;
+	constexpr float FRAME_DELTA = 1.f / 60.f;
+	constexpr float TIME_DELTA = 1.f;
+
+	// the first evaluation and the frames around it grow the reused buffers
+	constexpr int WARMUP_FRAMES = 2;
+
+	// generous for a CI machine, a regression in kind (a scan per bone, a copy per frame) still crosses them
+	constexpr double MAX_LOAD_MS = 5000.0;
+	constexpr double MAX_APPLY_P99_US = 2000.0;
+	constexpr double MAX_EVALUATION_US = 20000.0;
+
+	// Selection::Select builds the set of replaced bones per actor, nothing else may allocate once warm
+	constexpr std::int64_t MAX_APPLY_ALLOCATIONS = 0;
+	constexpr std::int64_t MAX_EVALUATION_ALLOCATIONS = ACTORS;
+
+	// game time, advanced by a fixed delta per frame instead of read from the system
+	class FakeClock
+	{
+	public:
+		void Advance(float a_delta) { _now += a_delta; }
+		float Now() const { return _now; }
+
+	private:
+		float _now = 0.f;
+	};
+
+	struct Transform
+	{
+		float rotate[3][3];
+		float translate[3];
+		float scale;
+	};
+
+	struct Limit
+	{
+		BoneID bone;
+		float low[3];
+		float high[3];
+	};
+
+	struct Item
+	{
+		std::string function;
+		std::string param;
+		std::string op;
+		float comparand = 0.f;
+		bool isOR = false;
+	};
+
+	struct Replacer
+	{
+		std::string name;
+		std::uint64_t priority = 0;
+		std::vector<Item> conditions;
+		std::vector<std::pair<BoneID, Transform>> overrides;
+		std::vector<Limit> limits;
+		BoneSet bones;
+
+		// required by a leading GetIsRace, 0 for none
+		std::uint32_t race = 0;
+	};
+
+	struct Generation
+	{
+		std::vector<Replacer> replacers;
+		std::vector<BoneSet> coverage;
+		std::vector<std::uint32_t> unindexed;
+		std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> raceIndex;
+	};
+
+	struct Actor
+	{
+		std::uint32_t id = 0;
+		std::uint32_t race = 0;
+
+		bool sneaking = false;
+		bool combat = false;
+		bool weaponDrawn = false;
+		float health = 100.f;
+
+		std::array<Transform, BONES> animated;
+		std::array<Transform, BONES> pose;
+		std::vector<std::uint32_t> selected;
+	};
+
+	std::string BoneName(std::size_t a_bone)
+	{
+		return "NPC Bone " + std::to_string(a_bone);
+	}
+
+	// the plugin's file format, one replacer per file
+	void WriteFiles(const fs::path& a_dir)
+	{
+		std::mt19937 rng{ 20261018 };
+		std::uniform_int_distribution<std::size_t> bones{ 0, BONES - 1 };
+		std::uniform_real_distribution<float> angles{ -FastMath::PI, FastMath::PI };
+
+		const std::array<std::string, 5> items{
+			"IsSneaking == 1",
+			"IsInCombat == 0",
+			"IsWeaponDrawn == 1",
+			"GetActorValuePercent Health < 50",
+			"IsInCombat == 1 OR",
+		};
+
+		fs::create_directories(a_dir);
+
+		for (std::size_t i = 0; i < FILES; ++i) {
+			std::vector<std::string> conditions;
+			if (rng() % 2) {
+				conditions.push_back("GetIsRace Race" + std::to_string(1 + rng() % RACES) + " == 1");
+			}
+			const auto count = 1 + rng() % 2;
+			for (std::size_t k = 0; k < count; ++k) {
+				conditions.push_back(items[rng() % items.size()]);
+			}
+			if (conditions.back().ends_with("OR")) {
+				conditions.push_back("IsSneaking == 0");
+			}
+
+			json frame = json::array();
+			const auto overrides = 1 + rng() % 3;
+			for (std::size_t k = 0; k < overrides; ++k) {
+				float rotate[3][3];
+				const float eulers[3]{ angles(rng) * 0.25f, angles(rng), angles(rng) };
+				FastMath::EulerYXZToMat(rotate, eulers);
+
+				frame.push_back(json{
+					{ "name", BoneName(bones(rng)) },
+					{ "rotate", rotate },
+					{ "translate", json{ { "x", 0.f }, { "y", 1.f }, { "z", 0.f } } } });
+			}
+
+			json limits = json::array();
+			if (rng() % 3 == 0) {
+				limits.push_back(json{
+					{ "name", BoneName(bones(rng)) },
+					{ "rotate_low", std::array<float, 3>{ -30.f, -45.f, -30.f } },
+					{ "rotate_high", std::array<float, 3>{ 30.f, 45.f, 30.f } } });
+			}
+
+			const json file{
+				{ "priority", rng() % 1000 },
+				{ "conditions", conditions },
+				{ "frames", json::array({ frame }) },
+				{ "limits", limits } };
+
+			std::ofstream{ a_dir / ("replacer" + std::to_string(i) + ".json") } << file;
+		}
+	}
+
+	std::unordered_map<std::string, BoneID> boneTable;
+
+	BoneID Intern(const std::string& a_name)
+	{
+		return boneTable.try_emplace(a_name, static_cast<BoneID>(boneTable.size())).first->second;
+	}
+
+	bool Load(const fs::path& a_file, Replacer& a_replacer)
+	{
+		std::ifstream stream{ a_file, std::ios::binary };
+		const auto file = json::parse(stream);
+
+		a_replacer.name = a_file.filename().string();
+		a_replacer.priority = file.value("priority", std::uint64_t{ 0 });
+
+		for (const auto& text : file.value("conditions", std::vector<std::string>{})) {
+			ConditionSyntax::Condition condition;
+			if (!ConditionSyntax::Parse(text, condition))
+				return false;
+
+			float comparand = 0.f;
+			const auto& word = condition.comparand;
+			if (std::from_chars(word.data(), word.data() + word.size(), comparand).ec != std::errc{})
+				return false;
+
+			a_replacer.conditions.push_back(Item{ condition.function, condition.params[0], condition.op, comparand, condition.isOR });
+		}
+
+		// a leading AND-ed race requirement, like Prefilter's
+		const auto& first = a_replacer.conditions.front();
+		if (first.function == "GetIsRace" && !first.isOR) {
+			a_replacer.race = static_cast<std::uint32_t>(std::stoul(first.param.substr(4)));
+		}
+
+		for (const auto& frame : file.at("frames")) {
+			for (const auto& override : frame) {
+				auto& [bone, transform] = a_replacer.overrides.emplace_back();
+				bone = Intern(override.at("name").get<std::string>());
+
+				const auto& rotate = override.at("rotate");
+				for (int i = 0; i < 3; ++i) {
+					for (int k = 0; k < 3; ++k) {
+						transform.rotate[i][k] = rotate[i][k].get<float>();
+					}
+				}
+
+				const auto& translate = override.at("translate");
+				transform.translate[0] = translate.value("x", 0.f);
+				transform.translate[1] = translate.value("y", 0.f);
+				transform.translate[2] = translate.value("z", 0.f);
+				transform.scale = override.value("scale", 1.f);
+
+				a_replacer.bones.Insert(bone);
+			}
+		}
+
+		for (const auto& lim : file.at("limits")) {
+			auto& limit = a_replacer.limits.emplace_back();
+			limit.bone = Intern(lim.at("name").get<std::string>());
+
+			const auto low = lim.value("rotate_low", std::array<float, 3>{});
+			const auto high = lim.value("rotate_high", std::array<float, 3>{});
+			for (int i = 0; i < 3; ++i) {
+				limit.low[i] = low[i] * FastMath::PI / 180.f;
+				limit.high[i] = high[i] * FastMath::PI / 180.f;
+			}
+
+			a_replacer.bones.Insert(limit.bone);
+		}
+
+		return true;
+	}
+
+	// sorted by decreasing priority, the race index and the coverage like ReplacerManager::BuildIndex
+	void Index(Generation& a_generation)
+	{
+		auto& replacers = a_generation.replacers;
+		std::ranges::sort(replacers, [](const Replacer& a, const Replacer& b) {
+			return a.priority != b.priority ? a.priority > b.priority : a.name < b.name;
+		});
+
+		for (std::uint32_t i = 0; i < replacers.size(); ++i) {
+			if (replacers[i].race) {
+				a_generation.raceIndex[replacers[i].race].push_back(i);
+			} else {
+				a_generation.unindexed.push_back(i);
+			}
+		}
+
+		Selection::BuildCoverage(replacers.size(), [&](std::size_t a_index) -> const BoneSet& {
+			return replacers[a_index].bones;
+		}, a_generation.coverage);
+	}
+
+	float Value(const Actor& a_actor, const Item& a_item)
+	{
+		if (a_item.function == "IsSneaking")
+			return a_actor.sneaking;
+		if (a_item.function == "IsInCombat")
+			return a_actor.combat;
+		if (a_item.function == "IsWeaponDrawn")
+			return a_actor.weaponDrawn;
+		if (a_item.function == "GetActorValuePercent")
+			return a_actor.health;
+		if (a_item.function == "GetIsRace")
+			return a_item.param == "Race" + std::to_string(a_actor.race) ? 1.f : 0.f;
+		return 0.f;
+	}
+
+	bool Test(const Actor& a_actor, const Item& a_item)
+	{
+		const auto value = Value(a_actor, a_item);
+		const auto& op = a_item.op;
+		if (op == "==")
+			return value == a_item.comparand;
+		if (op == "!=")
+			return value != a_item.comparand;
+		if (op == ">")
+			return value > a_item.comparand;
+		if (op == ">=")
+			return value >= a_item.comparand;
+		if (op == "<")
+			return value < a_item.comparand;
+		return value <= a_item.comparand;
+	}
+
+	// OR binds tighter than AND, like TESCondition
+	bool Eval(const Actor& a_actor, const std::vector<Item>& a_conditions)
+	{
+		bool group = false;
+		for (const auto& item : a_conditions) {
+			group = group || Test(a_actor, item);
+			if (!item.isOR) {
+				if (!group)
+					return false;
+				group = false;
+			}
+		}
+		return true;
+	}
+
+	// the actor's state changes with game time, so selections change between evaluations
+	void Update(Actor& a_actor, float a_now)
+	{
+		const auto second = static_cast<std::uint32_t>(a_now);
+		a_actor.sneaking = (a_actor.id + second) % 3 == 0;
+		a_actor.combat = (a_actor.id + second) % 5 < 2;
+		a_actor.weaponDrawn = a_actor.combat || (a_actor.id + second) % 7 == 0;
+		a_actor.health = static_cast<float>((a_actor.id * 37 + second * 11) % 100);
+	}
+
+	void Evaluate(const Generation& a_generation, Actor& a_actor, std::vector<std::uint32_t>& a_candidates)
+	{
+		const auto race = a_generation.raceIndex.find(a_actor.race);
+
+		a_candidates.clear();
+		Selection::MergeCandidates(a_generation.unindexed, race != a_generation.raceIndex.end() ? &race->second : nullptr, a_candidates);
+
+		a_actor.selected.clear();
+		Selection::Select(
+			a_candidates,
+			a_generation.coverage,
+			[&](std::uint32_t a_index) -> const BoneSet& {
+				return a_generation.replacers[a_index].bones;
+			},
+			[&](std::uint32_t a_index) {
+				return Eval(a_actor, a_generation.replacers[a_index].conditions);
+			},
+			[&](std::uint32_t a_index) {
+				a_actor.selected.push_back(a_index);
+			});
+	}
+
+	// stands in for the animation graph, not part of the measured cost
+	void Animate(Actor& a_actor, float a_now)
+	{
+		for (std::size_t bone = 0; bone < BONES; ++bone) {
+			auto& transform = a_actor.animated[bone];
+			const auto phase = a_now * 2.f + static_cast<float>(bone + a_actor.id) * 0.1f;
+			const float eulers[3]{ 0.3f * std::sin(phase), 0.5f * std::cos(phase), 0.2f * std::sin(phase * 0.5f) };
+			FastMath::EulerYXZToMat(transform.rotate, eulers);
+			transform.translate[0] = transform.translate[1] = transform.translate[2] = 0.f;
+			transform.scale = 1.f;
+		}
+	}
+
+	// overrides of the selected replacers, then their limits on the result, like Replacer::ApplyLimit's rotation channel
+	void Apply(const Generation& a_generation, Actor& a_actor)
+	{
+		a_actor.pose = a_actor.animated;
+
+		for (const auto index : a_actor.selected) {
+			const auto& replacer = a_generation.replacers[index];
+			for (const auto& [bone, transform] : replacer.overrides) {
+				a_actor.pose[bone] = transform;
+			}
+
+			for (const auto& limit : replacer.limits) {
+				auto& rotate = a_actor.pose[limit.bone].rotate;
+
+				float eulers[3];
+				FastMath::MatToEulerYXZ(rotate, eulers);
+				for (int i = 0; i < 3; ++i) {
+					eulers[i] = std::clamp(eulers[i], limit.low[i], limit.high[i]);
+				}
+				FastMath::EulerYXZToMat(rotate, eulers);
+			}
+		}
+	}
+
+	double Microseconds(std::chrono::steady_clock::duration a_duration)
+	{
+		return std::chrono::duration<double, std::micro>(a_duration).count();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	// sanitizers and unoptimized builds are too slow for the time limits, the allocation limits still hold
+#if defined(NDEBUG) && !defined(__SANITIZE_THREAD__)
+	bool timeLimits = true;
+#else
+	bool timeLimits = false;
+#endif
+	if (argc > 1 && std::string_view{ argv[1] } == "--no-time-limits") {
+		timeLimits = false;
+	}
+
+	const auto dir = fs::temp_directory_path() / "PARCrowdBenchmark";
+	fs::remove_all(dir);
+	WriteFiles(dir);
+
+	Generation generation;
+
+	const auto loadStart = std::chrono::steady_clock::now();
+	for (const auto& file : fs::directory_iterator(dir)) {
+		if (!Load(file.path(), generation.replacers.emplace_back())) {
+			std::printf("failed to load %s\n", file.path().string().c_str());
+			generation.replacers.pop_back();
+		}
+	}
+	Index(generation);
+	const auto loadMs = Microseconds(std::chrono::steady_clock::now() - loadStart) / 1000.0;
+
+	fs::remove_all(dir);
+
+	CHECK(generation.replacers.size() == FILES);
+	CHECK(boneTable.size() <= BONES);
+
+	std::vector<Actor> actors(ACTORS);
+	for (std::uint32_t i = 0; i < ACTORS; ++i) {
+		actors[i].id = 0x14 + i;
+		actors[i].race = 1 + i % RACES;
+		// never more replacers than bones, every one of them claims at least one
+		actors[i].selected.reserve(BONES);
+	}
+
+	std::vector<std::uint32_t> candidates;
+	candidates.reserve(FILES);
+
+	FakeClock clock;
+	float lastUpdated = 0.f;
+	bool loaded = false;
+
+	std::vector<double> applyCosts;
+	applyCosts.reserve(FRAMES);
+	double evaluationMax = 0.0;
+	double evaluationTotal = 0.0;
+	int evaluations = 0;
+	std::size_t selections = 0;
+
+	std::int64_t applyAllocations = 0;
+	std::int64_t evaluationAllocations = 0;
+
+	for (int frame = 0; frame < FRAMES; ++frame) {
+		clock.Advance(FRAME_DELTA);
+		lastUpdated += FRAME_DELTA;
+
+		for (auto& actor : actors) {
+			Animate(actor, clock.Now());
+		}
+
+		const bool warm = frame >= WARMUP_FRAMES;
+
+		if (!loaded || lastUpdated >= TIME_DELTA) {
+			loaded = true;
+			lastUpdated = 0.f;
+
+			const auto before = allocations.load();
+			const auto start = std::chrono::steady_clock::now();
+			for (auto& actor : actors) {
+				Update(actor, clock.Now());
+				Evaluate(generation, actor, candidates);
+				selections += actor.selected.size();
+			}
+			const auto cost = Microseconds(std::chrono::steady_clock::now() - start);
+
+			evaluationMax = std::max(evaluationMax, cost);
+			evaluationTotal += cost;
+			evaluations += 1;
+			if (warm) {
+				evaluationAllocations = std::max(evaluationAllocations, allocations.load() - before);
+			}
+		}
+
+		const auto before = allocations.load();
+		const auto start = std::chrono::steady_clock::now();
+		for (auto& actor : actors) {
+			Apply(generation, actor);
+		}
+		applyCosts.push_back(Microseconds(std::chrono::steady_clock::now() - start));
+		if (warm) {
+			applyAllocations = std::max(applyAllocations, allocations.load() - before);
+		}
+	}
+
+	std::ranges::sort(applyCosts);
+	const auto applyP50 = applyCosts[applyCosts.size() / 2];
+	const auto applyP99 = applyCosts[applyCosts.size() * 99 / 100];
+
+	std::printf("load: %zu files in %.1f ms, %zu bones\n", generation.replacers.size(), loadMs, boneTable.size());
+	std::printf("apply: %zu actors x %zu bones, p50 %.1f us, p99 %.1f us per frame, up to %lld allocations\n",
+		ACTORS, BONES, applyP50, applyP99, static_cast<long long>(applyAllocations));
+	std::printf("evaluation: %d passes, mean %.1f us, max %.1f us, %.1f replacers per actor, up to %lld allocations\n",
+		evaluations, evaluationTotal / evaluations, evaluationMax, static_cast<double>(selections) / static_cast<double>(evaluations * ACTORS),
+		static_cast<long long>(evaluationAllocations));
+
+	// the crowd has to select something, or the costs above measure nothing
+	CHECK(selections > 0);
+	CHECK(evaluations >= static_cast<int>(FRAMES * FRAME_DELTA / TIME_DELTA));
+
+	CHECK(applyAllocations <= MAX_APPLY_ALLOCATIONS);
+	CHECK(evaluationAllocations <= MAX_EVALUATION_ALLOCATIONS);
+
+	if (timeLimits) {
+		CHECK(loadMs <= MAX_LOAD_MS);
+		CHECK(applyP99 <= MAX_APPLY_P99_US);
+		CHECK(evaluationMax <= MAX_EVALUATION_US);
+	} else {
+		std::printf("time limits not checked\n");
+	}
+
+	return Harness::Result();
+}
@@ -0,0 +1,112 @@
+// Throughput of the rotation limit per bone, the libm conversions against FastMath's, one bone per call
+// Not a test, build with optimizations and run it directly
+
+#include "FastMath.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace PAR;
+
+namespace
+{
+	struct Bone
+	{
+		float rot[3][3];
+	};
+
+	// the conversions as they were before FastMath
+	void MatToEulerLibm(const float (&R)[3][3], float (&a_angles)[3])
+	{
+		if (R[1][2] <= 0.99999f && R[1][2] >= -0.99999f) {
+			a_angles[0] = std::asin(-R[1][2]);
+			a_angles[1] = std::atan2(R[0][2], R[2][2]);
+			a_angles[2] = std::atan2(R[1][0], R[1][1]);
+		} else {
+			a_angles[0] = R[1][2] < 0.f ? FastMath::HALF_PI : -FastMath::HALF_PI;
+			a_angles[1] = 0.f;
+			a_angles[2] = std::atan2(-R[0][1], R[0][0]);
+		}
+	}
+
+	void EulerToMatLibm(float (&R)[3][3], const float (&a_angles)[3])
+	{
+		const float cx = std::cos(a_angles[0]), sx = std::sin(a_angles[0]);
+		const float cy = std::cos(a_angles[1]), sy = std::sin(a_angles[1]);
+		const float cz = std::cos(a_angles[2]), sz = std::sin(a_angles[2]);
+
+		R[0][0] = cy * cz + sx * sy * sz;
+		R[0][1] = cz * sx * sy - cy * sz;
+		R[0][2] = cx * sy;
+		R[1][0] = cx * sz;
+		R[1][1] = cx * cz;
+		R[1][2] = -sx;
+		R[2][0] = cy * sx * sz - cz * sy;
+		R[2][1] = cy * cz * sx + sy * sz;
+		R[2][2] = cx * cy;
+	}
+
+	// Replacer::ApplyLimit's rotation channel
+	template <auto ToEuler, auto ToMat>
+	void Limit(std::vector<Bone>& a_bones)
+	{
+		for (auto& bone : a_bones) {
+			float eulers[3];
+			ToEuler(bone.rot, eulers);
+			for (int i = 0; i < 3; ++i) {
+				eulers[i] = std::clamp(eulers[i], -0.5f, 0.5f);
+			}
+			ToMat(bone.rot, eulers);
+		}
+	}
+
+	template <auto ToEuler, auto ToMat>
+	double Measure(const char* a_name, const std::vector<Bone>& a_bones)
+	{
+		constexpr int ROUNDS = 200;
+
+		double best = 1e300;
+		for (int round = 0; round < ROUNDS; ++round) {
+			auto bones = a_bones;
+
+			const auto start = std::chrono::steady_clock::now();
+			Limit<ToEuler, ToMat>(bones);
+			const auto end = std::chrono::steady_clock::now();
+
+			best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(bones.size()));
+
+			// keeps the limits from being optimized away
+			[[maybe_unused]] volatile float sink = bones.back().rot[0][0];
+		}
+
+		std::printf("%-8s %7.2f ns per bone (%.1f M bones/s)\n", a_name, best, 1e3 / best);
+		return best;
+	}
+}
+
+int main()
+{
+	// a crowd of actors with limited bones
+	constexpr std::size_t BONES = 4096;
+
+	std::mt19937 rng{ 20261018 };
+	std::uniform_real_distribution<float> turns{ -FastMath::PI, FastMath::PI };
+	std::uniform_real_distribution<float> tilts{ -FastMath::HALF_PI, FastMath::HALF_PI };
+
+	std::vector<Bone> bones(BONES);
+	for (auto& bone : bones) {
+		const float angles[3]{ tilts(rng), turns(rng), turns(rng) };
+		EulerToMatLibm(bone.rot, angles);
+	}
+
+	const auto libm = Measure<MatToEulerLibm, EulerToMatLibm>("libm", bones);
+	const auto fast = Measure<FastMath::MatToEulerYXZ, FastMath::EulerYXZToMat>("FastMath", bones);
+
+	std::printf("speedup %.2fx\n", libm / fast);
+
+	return 0;
+}
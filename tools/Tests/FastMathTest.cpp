@@ -0,0 +1,214 @@
+// Properties of the polynomial sincos/asin/atan2 against libm, each lane on its own input, and the Euler
+// conversions built on them, gimbal lock included
+
+#include "FastMath.h"
+#include "Harness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace PAR;
+
+namespace
+{
+	constexpr double PI = 3.14159265358979323846;
+
+	struct Lanes
+	{
+		alignas(16) float v[4];
+
+		__m128 Load() const { return _mm_load_ps(v); }
+		static Lanes Store(__m128 a_v)
+		{
+			Lanes lanes;
+			_mm_store_ps(lanes.v, a_v);
+			return lanes;
+		}
+	};
+
+	// distance between two angles, +-pi are the same one
+	double AngleError(double a_lhs, double a_rhs)
+	{
+		const auto error = std::fmod(std::abs(a_lhs - a_rhs), 2.0 * PI);
+		return std::min(error, 2.0 * PI - error);
+	}
+
+	// random inputs, spread over the lanes, plus the fixed edge cases in every lane
+	template <class Gen, class Check>
+	void ForAll(Gen&& a_gen, std::initializer_list<float> a_edges, Check&& a_check)
+	{
+		for (const auto edge : a_edges) {
+			a_check(Lanes{ { edge, edge, edge, edge } });
+		}
+
+		for (int i = 0; i < 1 << 16; ++i) {
+			a_check(Lanes{ { a_gen(), a_gen(), a_gen(), a_gen() } });
+		}
+	}
+
+	std::mt19937 rng{ 20261018 };
+
+	void SinCos()
+	{
+		// the limits stay within a few turns, the range reduction is exact enough there
+		std::uniform_real_distribution<float> angles{ -4.f * FastMath::TWO_PI, 4.f * FastMath::TWO_PI };
+
+		double sinError = 0.0;
+		double cosError = 0.0;
+		ForAll([&]() { return angles(rng); },
+			{ 0.f, -0.f, FastMath::HALF_PI, -FastMath::HALF_PI, FastMath::PI, -FastMath::PI, FastMath::TWO_PI, 3.f * FastMath::HALF_PI },
+			[&](const Lanes& a_x) {
+				__m128 s;
+				__m128 c;
+				FastMath::SinCos(a_x.Load(), s, c);
+				const auto sines = Lanes::Store(s);
+				const auto cosines = Lanes::Store(c);
+
+				for (int lane = 0; lane < 4; ++lane) {
+					const double x = a_x.v[lane];
+					sinError = std::max(sinError, std::abs(sines.v[lane] - std::sin(x)));
+					cosError = std::max(cosError, std::abs(cosines.v[lane] - std::cos(x)));
+				}
+			});
+
+		std::printf("sin max error %g, cos max error %g\n", sinError, cosError);
+		CHECK(sinError < 2e-6);
+		CHECK(cosError < 2e-6);
+	}
+
+	void ASin()
+	{
+		std::uniform_real_distribution<float> values{ -1.f, 1.f };
+
+		double error = 0.0;
+		ForAll([&]() { return values(rng); },
+			{ 0.f, -0.f, 1.f, -1.f, 0.5f, -0.5f, 0.99999f, -0.99999f, std::nextafter(1.f, 0.f) },
+			[&](const Lanes& a_x) {
+				const auto result = Lanes::Store(FastMath::ASin(a_x.Load()));
+				for (int lane = 0; lane < 4; ++lane) {
+					error = std::max(error, std::abs(result.v[lane] - std::asin(static_cast<double>(a_x.v[lane]))));
+				}
+			});
+
+		// inputs past +-1 are clamped
+		const auto clamped = Lanes::Store(FastMath::ASin(_mm_setr_ps(1.5f, -1.5f, 1.f, -1.f)));
+		CHECK(std::abs(clamped.v[0] - FastMath::HALF_PI) < 1e-6f);
+		CHECK(std::abs(clamped.v[1] + FastMath::HALF_PI) < 1e-6f);
+
+		std::printf("asin max error %g\n", error);
+		CHECK(error < 1e-6);
+	}
+
+	void ATan2()
+	{
+		std::uniform_real_distribution<float> coords{ -10.f, 10.f };
+
+		double error = 0.0;
+		const auto check = [&](const Lanes& a_y, const Lanes& a_x) {
+			const auto result = Lanes::Store(FastMath::ATan2(a_y.Load(), a_x.Load()));
+			for (int lane = 0; lane < 4; ++lane) {
+				const double y = a_y.v[lane];
+				const double x = a_x.v[lane];
+				if (x == 0.0 && y == 0.0) {
+					CHECK(result.v[lane] == 0.f || std::abs(AngleError(result.v[lane], PI)) < 1e-6);
+					continue;
+				}
+				error = std::max(error, AngleError(result.v[lane], std::atan2(y, x)));
+			}
+		};
+
+		// every quadrant and both axes
+		for (const float y : { -2.f, -1.f, -0.f, 0.f, 1.f, 2.f }) {
+			for (const float x : { -2.f, -1.f, -0.f, 0.f, 1.f, 2.f }) {
+				check(Lanes{ { y, y, y, y } }, Lanes{ { x, x, x, x } });
+			}
+		}
+
+		for (int i = 0; i < 1 << 16; ++i) {
+			check(Lanes{ { coords(rng), coords(rng), coords(rng), coords(rng) } }, Lanes{ { coords(rng), coords(rng), coords(rng), coords(rng) } });
+		}
+
+		std::printf("atan2 max error %g\n", error);
+		CHECK(error < 1e-6);
+	}
+
+	double MatrixError(const float (&a_lhs)[3][3], const float (&a_rhs)[3][3])
+	{
+		double error = 0.0;
+		for (int i = 0; i < 3; ++i) {
+			for (int k = 0; k < 3; ++k) {
+				error = std::max(error, static_cast<double>(std::abs(a_lhs[i][k] - a_rhs[i][k])));
+			}
+		}
+		return error;
+	}
+
+	// angles -> matrix -> angles -> matrix, the rotation has to survive the round trip
+	void EulerRoundTrip()
+	{
+		std::uniform_real_distribution<float> turns{ -FastMath::PI, FastMath::PI };
+		std::uniform_real_distribution<float> tilts{ -FastMath::HALF_PI, FastMath::HALF_PI };
+
+		double error = 0.0;
+		double lockError = 0.0;
+		for (int i = 0; i < 1 << 16; ++i) {
+			// every 4th rotation is exactly in gimbal lock, alternating between +-90 degrees
+			const bool lock = i % 4 == 0;
+			const float angles[3]{ lock ? (i % 8 ? FastMath::HALF_PI : -FastMath::HALF_PI) : tilts(rng), turns(rng), turns(rng) };
+
+			float rot[3][3];
+			FastMath::EulerYXZToMat(rot, angles);
+
+			float recovered[3];
+			FastMath::MatToEulerYXZ(rot, recovered);
+
+			float again[3][3];
+			FastMath::EulerYXZToMat(again, recovered);
+
+			if (lock) {
+				CHECK(recovered[1] == 0.f);
+				CHECK(std::abs(recovered[0] - angles[0]) < 1e-6f);
+				lockError = std::max(lockError, MatrixError(rot, again));
+			} else {
+				error = std::max(error, MatrixError(rot, again));
+			}
+		}
+
+		std::printf("euler round trip max error %g, in gimbal lock %g\n", error, lockError);
+
+		// past the +-0.99999 threshold y is dropped, a rotation that close to the lock moves by up to ~5e-3
+		CHECK(error < 1e-2);
+		CHECK(lockError < 1e-5);
+
+		// away from the lock the angles themselves come back
+		float max = 0.f;
+		for (int i = 0; i < 1 << 16; ++i) {
+			const float angles[3]{ tilts(rng) * 0.99f, turns(rng), turns(rng) };
+
+			float rot[3][3];
+			FastMath::EulerYXZToMat(rot, angles);
+
+			float recovered[3];
+			FastMath::MatToEulerYXZ(rot, recovered);
+
+			for (int k = 0; k < 3; ++k) {
+				max = std::max(max, static_cast<float>(AngleError(recovered[k], angles[k])));
+			}
+		}
+
+		std::printf("euler angle max error %g\n", max);
+		CHECK(max < 1e-4f);
+	}
+}
+
+int main()
+{
+	SinCos();
+	ASin();
+	ATan2();
+	EulerRoundTrip();
+
+	return Harness::Result();
+}
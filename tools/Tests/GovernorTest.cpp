@@ -0,0 +1,149 @@
+// Drives the governor with a synthetic cost model, each level sheds a fixed share of the apply cost
+
+#include "Governor.h"
+#include "Harness.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <utility>
+
+using namespace PAR;
+using namespace std::chrono_literals;
+
+namespace
+{
+	constexpr Governor::Config CONFIG{ .budgetUs = 1000.f, .recoverRatio = 0.6f, .degradeFrames = 5, .recoverFrames = 120 };
+
+	// fraction of the full cost left at each level
+	constexpr std::array<float, 4> SHARE{ 1.f, 0.75f, 0.45f, 0.1f };
+
+	std::chrono::nanoseconds Cost(const Governor& a_governor, float a_fullUs)
+	{
+		const auto share = SHARE[std::to_underlying(a_governor.GetLevel())];
+		return std::chrono::nanoseconds{ static_cast<std::int64_t>(a_fullUs * share * 1000.f) };
+	}
+
+	// frames until the level changes, or a_limit if it doesn't
+	std::uint32_t RunUntilChange(Governor& a_governor, float a_fullUs, std::uint32_t a_limit)
+	{
+		for (std::uint32_t frame = 1; frame <= a_limit; ++frame) {
+			if (a_governor.Update(Cost(a_governor, a_fullUs)))
+				return frame;
+		}
+		return a_limit;
+	}
+
+	void Disabled()
+	{
+		Governor governor;
+		governor.Configure(Governor::Config{});
+
+		for (int frame = 0; frame < 1000; ++frame) {
+			CHECK(!governor.Update(1s));
+		}
+		CHECK(governor.GetLevel() == Governor::Level::kFull);
+	}
+
+	// a sustained overload steps down one level per degradeFrames until the cost fits the budget
+	void StepDown()
+	{
+		Governor governor;
+		governor.Configure(CONFIG);
+
+		// 2000us: 2000, 1500, 900 - fits at kHalfRate
+		CHECK(RunUntilChange(governor, 2000.f, 100) == CONFIG.degradeFrames);
+		CHECK(governor.GetLevel() == Governor::Level::kNearLimits);
+		CHECK(RunUntilChange(governor, 2000.f, 100) == CONFIG.degradeFrames);
+		CHECK(governor.GetLevel() == Governor::Level::kHalfRate);
+
+		// 900us is within the budget but over the recovery threshold, the level holds
+		CHECK(RunUntilChange(governor, 2000.f, 10000) == 10000);
+		CHECK(governor.GetLevel() == Governor::Level::kHalfRate);
+	}
+
+	// spikes shorter than degradeFrames never change the level
+	void Spikes()
+	{
+		Governor governor;
+		governor.Configure(CONFIG);
+
+		for (int burst = 0; burst < 100; ++burst) {
+			for (std::uint32_t frame = 0; frame + 1 < CONFIG.degradeFrames; ++frame) {
+				CHECK(!governor.Update(5ms));
+			}
+			CHECK(!governor.Update(500us));
+		}
+		CHECK(governor.GetLevel() == Governor::Level::kFull);
+	}
+
+	// the lowest level is kept however long the overload lasts
+	void Clamped()
+	{
+		Governor governor;
+		governor.Configure(CONFIG);
+
+		for (int frame = 0; frame < 1000; ++frame) {
+			governor.Update(1s);
+		}
+		CHECK(governor.GetLevel() == Governor::Level::kPlayerOnly);
+		CHECK(!governor.Update(1s));
+	}
+
+	// once the scene lightens each level is restored after recoverFrames under the threshold, one at a time
+	void Recover()
+	{
+		Governor governor;
+		governor.Configure(CONFIG);
+
+		while (governor.GetLevel() != Governor::Level::kPlayerOnly) {
+			governor.Update(1s);
+		}
+
+		// 400us stays under 600us at every level
+		for (int level = 3; level > 0; --level) {
+			CHECK(RunUntilChange(governor, 400.f, 1000) == CONFIG.recoverFrames);
+			CHECK(std::to_underlying(governor.GetLevel()) == static_cast<std::uint32_t>(level - 1));
+		}
+		CHECK(RunUntilChange(governor, 400.f, 1000) == 1000);
+	}
+
+	// a load that fits one level but not the one above must not oscillate between them
+	void Hysteresis()
+	{
+		Governor governor;
+		governor.Configure(CONFIG);
+
+		std::mt19937 rng{ 0x474F56 };
+		std::uniform_real_distribution noise{ 0.9f, 1.1f };
+
+		// kNearLimits costs 825us +-10%, kFull 1100us +-10%
+		std::uint32_t changes = 0;
+		for (int frame = 0; frame < 100000; ++frame) {
+			changes += governor.Update(Cost(governor, 1100.f * noise(rng)));
+		}
+
+		CHECK(changes <= 2);
+		CHECK(governor.GetLevel() == Governor::Level::kNearLimits);
+
+		// a cost that alternates across both thresholds keeps breaking the streaks
+		governor.Configure(CONFIG);
+		for (int frame = 0; frame < 100000; ++frame) {
+			CHECK(!governor.Update(frame & 1 ? 1500us : 300us));
+		}
+		CHECK(governor.GetLevel() == Governor::Level::kFull);
+	}
+}
+
+int main()
+{
+	Disabled();
+	StepDown();
+	Spikes();
+	Clamped();
+	Recover();
+	Hysteresis();
+
+	return Harness::Result();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal checks for the harnesses, a failed check is reported and turns the exit code non-zero
+
+namespace Harness
+{
+	inline int failures = 0;
+
+	inline int Result()
+	{
+		if (failures) {
+			std::printf("%d checks failed\n", failures);
+			return 1;
+		}
+		std::printf("all checks passed\n");
+		return 0;
+	}
+}
+
+#define CHECK(expr)                                                                 \
+	do {                                                                            \
+		if (!(expr)) {                                                              \
+			std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr);    \
+			Harness::failures += 1;                                                 \
+		}                                                                           \
+	} while (false)
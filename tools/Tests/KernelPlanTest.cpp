@@ -0,0 +1,224 @@
+// The interpreter of Replacer::ApplyOverride/ApplyLimit against the plan the kernels are emitted from, on stand-ins
+// for the game's transforms: random overrides, channels and limits, degenerate ranges included, on random
+// rotations in and near gimbal lock, both have to produce the same bits
+// the xbyak lowering itself is checked in game by Kernel::Verify
+
+#include "Harness.h"
+#include "KernelPlan.h"
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace PAR;
+
+namespace
+{
+	// laid out like RE::NiTransform
+	struct Matrix
+	{
+		float entry[3][3];
+	};
+
+	struct Point
+	{
+		float x;
+		float y;
+		float z;
+
+		float& operator[](std::size_t a_index) { return (&x)[a_index]; }
+		const float& operator[](std::size_t a_index) const { return (&x)[a_index]; }
+	};
+
+	struct Transform
+	{
+		Matrix rotate;
+		Point translate;
+		float scale;
+	};
+
+	struct Limit
+	{
+		std::uint16_t bone;
+		std::array<float, 3> rotate_low;
+		std::array<float, 3> rotate_high;
+		std::array<float, 3> translate_low;
+		std::array<float, 3> translate_high;
+		float scale_low;
+		float scale_high;
+	};
+
+	struct PoseOverride
+	{
+		std::uint16_t bone;
+		Transform transform;
+		std::uint8_t channels;
+	};
+
+	struct LiveLimit
+	{
+		const Limit* limit;
+		std::uint8_t channels;
+	};
+
+	std::mt19937 rng{ 20261018 };
+
+	float Uniform(float a_lo, float a_hi)
+	{
+		return std::uniform_real_distribution<float>{ a_lo, a_hi }(rng);
+	}
+
+	bool Chance(float a_probability)
+	{
+		return Uniform(0.f, 1.f) < a_probability;
+	}
+
+	// a third of the rotations exactly in gimbal lock, a third just short of it, where the Euler round trip drops y
+	Transform RandomTransform()
+	{
+		float eulers[3]{ Uniform(-FastMath::HALF_PI, FastMath::HALF_PI), Uniform(-FastMath::PI, FastMath::PI), Uniform(-FastMath::PI, FastMath::PI) };
+		const auto kind = rng() % 3;
+		const float sign = rng() % 2 ? 1.f : -1.f;
+		if (kind == 0) {
+			eulers[0] = sign * FastMath::HALF_PI;
+		} else if (kind == 1) {
+			eulers[0] = sign * (FastMath::HALF_PI - Uniform(0.f, 4e-3f));
+		}
+
+		Transform transform{};
+		FastMath::EulerYXZToMat(transform.rotate.entry, eulers);
+		transform.translate = Point{ Uniform(-20.f, 20.f), Uniform(-20.f, 20.f), Uniform(-20.f, 20.f) };
+		transform.scale = Uniform(0.5f, 1.5f);
+		return transform;
+	}
+
+	// a third of the ranges degenerate, lo above hi or equal to it
+	void RandomRange(float a_extent, float& a_lo, float& a_hi)
+	{
+		a_lo = Uniform(-a_extent, a_extent);
+		a_hi = Chance(0.33f) ? a_lo - Uniform(0.f, a_extent) : a_lo + Uniform(0.f, a_extent);
+	}
+
+	Limit RandomLimit()
+	{
+		Limit limit{};
+		// half the limits leave the rotation alone
+		const bool rotate = Chance(0.5f);
+		for (std::size_t axis = 0; axis < 3; ++axis) {
+			if (rotate) {
+				RandomRange(FastMath::PI, limit.rotate_low[axis], limit.rotate_high[axis]);
+			}
+			RandomRange(20.f, limit.translate_low[axis], limit.translate_high[axis]);
+		}
+		RandomRange(1.f, limit.scale_low, limit.scale_high);
+		return limit;
+	}
+
+	std::uint8_t RandomChannels()
+	{
+		return static_cast<std::uint8_t>(rng() % 8);
+	}
+
+	bool Same(const Transform& a_lhs, const Transform& a_rhs)
+	{
+		return std::memcmp(&a_lhs, &a_rhs, sizeof(Transform)) == 0;
+	}
+
+	void Differential()
+	{
+		constexpr int CASES = 1 << 14;
+
+		int differences = 0;
+		std::size_t ops = 0;
+		for (int i = 0; i < CASES; ++i) {
+			std::vector<PoseOverride> overrides(rng() % 5);
+			for (auto& override : overrides) {
+				override = PoseOverride{ 0, RandomTransform(), RandomChannels() };
+			}
+
+			std::vector<Limit> limitData(rng() % 5);
+			std::vector<LiveLimit> limits;
+			for (auto& limit : limitData) {
+				limit = RandomLimit();
+				limits.push_back(LiveLimit{ &limit, RandomChannels() });
+			}
+
+			// the kernel's layout, one transform per override then one per limit
+			std::vector<Transform> input(overrides.size() + limits.size());
+			for (auto& transform : input) {
+				transform = RandomTransform();
+			}
+
+			auto interpreted = input;
+			for (std::size_t k = 0; k < overrides.size(); ++k) {
+				TransformOps::ApplyOverride(interpreted[k], overrides[k]);
+			}
+			for (std::size_t k = 0; k < limits.size(); ++k) {
+				TransformOps::ApplyLimit(interpreted[overrides.size() + k], *limits[k].limit, limits[k].channels);
+			}
+
+			auto planned = input;
+			std::vector<Transform*> args;
+			for (auto& transform : planned) {
+				args.push_back(&transform);
+			}
+
+			const auto plan = KernelPlan::Build<Transform>(overrides, limits);
+			KernelPlan::Run(plan, limitData, args.data());
+			ops += plan.size();
+
+			for (std::size_t k = 0; k < input.size(); ++k) {
+				differences += !Same(interpreted[k], planned[k]);
+			}
+		}
+
+		std::printf("%d cases, %zu ops, %d transforms differ\n", CASES, ops, differences);
+		CHECK(differences == 0);
+	}
+
+	// a limit without any rotation range leaves a rotation at or near gimbal lock as it is, on both paths
+	void InactiveRotation()
+	{
+		Limit limit{};
+		limit.translate_low = { -1.f, -1.f, -1.f };
+		limit.translate_high = { 1.f, 1.f, 1.f };
+
+		const std::vector<LiveLimit> limits{ LiveLimit{ &limit, kRotate | kTranslate } };
+		const auto plan = KernelPlan::Build<Transform>(std::vector<PoseOverride>{}, limits);
+		CHECK(plan.size() == 3);
+		for (const auto& op : plan) {
+			CHECK(op.kind == KernelPlan::Op::Kind::kSaturateValue);
+		}
+
+		for (const float tilt : { FastMath::HALF_PI, -FastMath::HALF_PI, FastMath::HALF_PI - 1e-3f, -FastMath::HALF_PI + 2e-3f }) {
+			const float eulers[3]{ tilt, 0.7f, -1.1f };
+
+			Transform input{};
+			FastMath::EulerYXZToMat(input.rotate.entry, eulers);
+
+			auto interpreted = input;
+			TransformOps::ApplyLimit(interpreted, limit, kRotate | kTranslate);
+			CHECK(std::memcmp(&interpreted.rotate, &input.rotate, sizeof(Matrix)) == 0);
+
+			auto planned = input;
+			Transform* args[]{ &planned };
+			KernelPlan::Run(plan, std::vector<Limit>{ limit }, args);
+			CHECK(std::memcmp(&planned.rotate, &input.rotate, sizeof(Matrix)) == 0);
+		}
+
+		// nothing at all for a limit whose ranges are all degenerate
+		Limit degenerate{};
+		const std::vector<LiveLimit> none{ LiveLimit{ &degenerate, kRotate | kTranslate | kScale } };
+		CHECK(KernelPlan::Build<Transform>(std::vector<PoseOverride>{}, none).empty());
+	}
+}
+
+int main()
+{
+	Differential();
+	InactiveRotation();
+
+	return Harness::Result();
+}
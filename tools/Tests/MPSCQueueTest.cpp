@@ -0,0 +1,185 @@
+// Stress and visibility checks for the queue Dumper hands jobs over with
+
+#include "Harness.h"
+#include "MPSCQueue.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace PAR;
+
+namespace
+{
+	// every item arrives exactly once, in the order its producer pushed it
+	void StressProducers()
+	{
+		constexpr std::uint32_t PRODUCERS = 8;
+		constexpr std::uint32_t ITEMS = 200000;
+
+		MPSCQueue<std::uint64_t> queue;
+
+		std::vector<std::thread> producers;
+		for (std::uint32_t p = 0; p < PRODUCERS; ++p) {
+			producers.emplace_back([&queue, p]() {
+				for (std::uint32_t i = 0; i < ITEMS; ++i) {
+					queue.Push((std::uint64_t{ p } << 32) | i);
+				}
+			});
+		}
+
+		std::vector<std::uint32_t> next(PRODUCERS, 0);
+		std::uint64_t received = 0;
+		bool ordered = true;
+
+		while (received < std::uint64_t{ PRODUCERS } * ITEMS) {
+			if (const auto item = queue.Pop()) {
+				const auto producer = static_cast<std::uint32_t>(*item >> 32);
+				const auto index = static_cast<std::uint32_t>(*item);
+				ordered &= producer < PRODUCERS && index == next[producer];
+				if (producer < PRODUCERS) {
+					next[producer] = index + 1;
+				}
+				received += 1;
+			}
+		}
+
+		for (auto& producer : producers) {
+			producer.join();
+		}
+
+		CHECK(ordered);
+		CHECK(!queue.Pop());
+		for (const auto count : next) {
+			CHECK(count == ITEMS);
+		}
+	}
+
+	// Dumper drains at the start of every frame, a job whose Push returned before a frame started must be recorded on that frame
+	// reading the frame with a read-modify-write orders the Push before the frame the consumer starts next
+	void FrameExactCapture()
+	{
+		constexpr std::uint32_t JOBS = 100000;
+
+		MPSCQueue<std::uint32_t> queue;
+		std::atomic<std::uint32_t> frame = 0;
+		std::atomic<bool> done = false;
+
+		// latest frame each job may be drained on
+		std::vector<std::uint32_t> deadline(JOBS);
+		std::vector<std::uint32_t> drained(JOBS, UINT32_MAX);
+
+		std::thread consumer([&]() {
+			for (std::uint32_t f = 1;; ++f) {
+				const bool last = done.load();
+
+				frame.exchange(f);
+
+				while (const auto job = queue.Pop()) {
+					drained[*job] = f;
+				}
+
+				if (last)
+					break;
+			}
+		});
+
+		for (std::uint32_t i = 0; i < JOBS; ++i) {
+			queue.Push(i);
+			deadline[i] = frame.fetch_add(0) + 1;
+		}
+
+		done = true;
+		consumer.join();
+
+		std::uint32_t late = 0;
+		for (std::uint32_t i = 0; i < JOBS; ++i) {
+			late += drained[i] > deadline[i];
+		}
+
+		CHECK(late == 0);
+	}
+
+	// with several producers a job can sit behind one whose producer has not linked it yet, it is late, never lost:
+	// it is drained by the first frame that starts once its own Push and every Push queued ahead of it returned,
+	// the next frame when no producer ahead of it is still linking
+	void FrameBoundWithProducers()
+	{
+		constexpr std::uint32_t PRODUCERS = 4;
+		constexpr std::uint32_t JOBS = 50000;
+
+		MPSCQueue<std::uint32_t> queue;
+		std::atomic<std::uint32_t> frame = 0;
+		std::atomic<std::uint32_t> finished = 0;
+
+		std::vector<std::uint32_t> deadline(PRODUCERS * JOBS);
+		std::vector<std::uint32_t> drained(PRODUCERS * JOBS, UINT32_MAX);
+
+		// the order the jobs were queued in, the queue hands them over in it
+		std::vector<std::uint32_t> order;
+		order.reserve(PRODUCERS * JOBS);
+
+		std::thread consumer([&]() {
+			for (std::uint32_t f = 1;; ++f) {
+				const bool last = finished.load() == PRODUCERS;
+
+				frame.exchange(f);
+
+				while (const auto job = queue.Pop()) {
+					drained[*job] = f;
+					order.push_back(*job);
+				}
+
+				if (last)
+					break;
+			}
+		});
+
+		std::vector<std::thread> producers;
+		for (std::uint32_t p = 0; p < PRODUCERS; ++p) {
+			producers.emplace_back([&, p]() {
+				for (std::uint32_t i = p * JOBS; i < (p + 1) * JOBS; ++i) {
+					queue.Push(i);
+					deadline[i] = frame.fetch_add(0) + 1;
+				}
+				finished += 1;
+			});
+		}
+
+		for (auto& producer : producers) {
+			producer.join();
+		}
+		consumer.join();
+
+		std::uint32_t lost = 0;
+		for (std::uint32_t i = 0; i < PRODUCERS * JOBS; ++i) {
+			lost += drained[i] == UINT32_MAX;
+		}
+
+		// late past its own deadline only while a job ahead of it was, never past theirs
+		std::uint32_t late = 0;
+		std::uint32_t beyond = 0;
+		std::uint32_t bound = 0;
+		for (const auto job : order) {
+			bound = std::max(bound, deadline[job]);
+			late += drained[job] > deadline[job];
+			beyond += drained[job] > bound;
+		}
+
+		CHECK(lost == 0);
+		CHECK(order.size() == PRODUCERS * JOBS);
+		CHECK(beyond == 0);
+		std::printf("%u of %u jobs from %u producers drained after their own next frame, all within the bound\n", late, PRODUCERS * JOBS, PRODUCERS);
+	}
+}
+
+int main()
+{
+	StressProducers();
+	FrameExactCapture();
+	FrameBoundWithProducers();
+
+	return Harness::Result();
+}
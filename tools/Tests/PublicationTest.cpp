@@ -0,0 +1,109 @@
+// Stress of the Publication between ReloadFile and EvaluateReplacers, run it under PAR_TSAN too
+
+#include "Harness.h"
+#include "Publication.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace PAR;
+
+namespace
+{
+	// stands in for a generation, only its version matters
+	struct Generation
+	{
+		std::uint64_t version;
+	};
+
+	// stands in for the selections, tagged with the generation they were evaluated against
+	struct Selections
+	{
+		std::uint64_t version;
+	};
+
+	struct State
+	{
+		// ReplacerManager's, over the stand-ins
+		Publication<Generation, Selections> publication;
+
+		// the last version whose invalidation is complete, nothing older may be published after it
+		std::atomic<std::uint64_t> invalidated{ 1 };
+		std::atomic<bool> done{ false };
+
+		State() { publication.Replace(std::make_shared<const Generation>(Generation{ 1 }), std::make_shared<Selections>(Selections{ 1 })); }
+	};
+
+	// ReloadFile: publish the generation, which replaces the selections with empty ones
+	void Reload(State& a_state, std::uint64_t a_version)
+	{
+		a_state.publication.Replace(std::make_shared<const Generation>(Generation{ a_version }), std::make_shared<Selections>(Selections{ a_version }));
+		a_state.invalidated.store(a_version);
+	}
+
+	// EvaluateReplacers: pin a generation, evaluate, publish unless it was replaced meanwhile
+	std::uint64_t Evaluate(State& a_state)
+	{
+		const auto generation = a_state.publication.Pin();
+
+		// widens the window between the pin and the publication
+		std::this_thread::yield();
+
+		const auto selections = std::make_shared<Selections>(Selections{ generation->version });
+		return a_state.publication.Publish(generation, selections) ? 1 : 0;
+	}
+
+	void Stress()
+	{
+		constexpr std::uint64_t RELOADS = 20000;
+		constexpr int EVALUATORS = 3;
+
+		State state;
+		std::atomic<std::uint64_t> published = 0;
+		std::atomic<std::uint64_t> stale = 0;
+
+		std::vector<std::thread> threads;
+		for (int i = 0; i < EVALUATORS; ++i) {
+			threads.emplace_back([&]() {
+				while (!state.done.load()) {
+					published += Evaluate(state);
+				}
+			});
+		}
+
+		// ApplyReplacers: once an invalidation completed, nothing evaluated against an older generation may show up
+		threads.emplace_back([&]() {
+			while (!state.done.load()) {
+				const auto invalidated = state.invalidated.load();
+				if (state.publication.Current()->version < invalidated) {
+					stale += 1;
+				}
+			}
+		});
+
+		// optimized, the reloads can outpace every evaluation, keep going until one of them got through
+		std::uint64_t version = 1;
+		while (version < RELOADS || published == 0) {
+			Reload(state, ++version);
+		}
+
+		state.done.store(true);
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		CHECK(stale == 0);
+		CHECK(published > 0);
+		CHECK(state.publication.Current()->version == version);
+	}
+}
+
+int main()
+{
+	Stress();
+
+	return Harness::Result();
+}
@@ -0,0 +1,398 @@
+// Checks replacer directories without the game, and optionally writes the bundle the plugin loads them from
+//
+// usage: PARValidator [--pack] [--functions <file>] <replacer dir>...
+//
+// --pack only writes the bundle of a directory without errors or warnings
+// --functions names a file with one condition function per line, unknown functions are only reported with it,
+// the function table belongs to the game
+
+#include "BundleFormat.h"
+#include "ConditionSyntax.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+using namespace PAR;
+
+namespace
+{
+	struct Entry
+	{
+		fs::path path;
+		std::int64_t mtime = 0;
+		std::vector<std::uint8_t> bytes;
+		std::optional<json> file;
+
+		std::uint64_t priority = 0;
+		std::set<std::string> bones;
+
+		// normalized condition items that must hold whenever the replacer passes, all of them without OR groups
+		std::set<std::string> required;
+		bool pureAnd = true;
+
+		std::vector<std::string> errors;
+	};
+
+	std::unordered_set<std::string> functions;
+
+	std::string Upper(std::string a_text)
+	{
+		std::ranges::transform(a_text, a_text.begin(), [](unsigned char a_char) { return static_cast<char>(std::toupper(a_char)); });
+		return a_text;
+	}
+
+	// the text an item is resolved from, so items that read differently but resolve the same compare equal
+	std::string Normalize(const ConditionSyntax::Condition& a_condition, const std::map<std::string, std::string>& a_refs)
+	{
+		// ConditionParser looks params up in the refs by their upper-cased text, the run-on ref by its text as is
+		const auto param = [&](const std::string& a_text) {
+			const auto upper = Upper(a_text);
+			const auto iter = a_refs.find(upper);
+			return iter != a_refs.end() ? Upper(iter->second) : upper;
+		};
+
+		const auto ref = a_refs.find(a_condition.ref);
+		auto text = (ref != a_refs.end() ? Upper(ref->second) : Upper(a_condition.ref)) + '|' + Upper(a_condition.function);
+		for (std::size_t i = 0; i < a_condition.numParams; ++i) {
+			text += '|' + param(a_condition.params[i]);
+		}
+
+		// numbers by value, anything else names a global
+		const auto& comparand = a_condition.comparand;
+		float value = 0.f;
+		const auto [end, ec] = std::from_chars(comparand.data(), comparand.data() + comparand.size(), value);
+		text += '|' + a_condition.op + '|' + (ec == std::errc{} && end == comparand.data() + comparand.size() ? std::to_string(value) : Upper(comparand));
+
+		return text;
+	}
+
+	// Mirrors Replacer::IsValid and ConditionParser::Parse without resolving any forms
+	void Validate(Entry& a_entry)
+	{
+		try {
+			a_entry.file = json::parse(a_entry.bytes);
+		} catch (std::exception& e) {
+			a_entry.errors.push_back(std::string{ "failed to parse - " } + e.what());
+			return;
+		}
+
+		try {
+			const auto& file = *a_entry.file;
+
+			a_entry.priority = file.value("priority", std::uint64_t{ 0 });
+
+			const auto refs = file.value("refs", std::map<std::string, std::string>{});
+			const auto conditions = file.value("conditions", std::vector<std::string>{});
+			const auto frames = file.value("frames", std::vector<json>{});
+			const auto limits = file.value("limits", std::vector<json>{});
+
+			std::vector<ConditionSyntax::Condition> items;
+			for (const auto& text : conditions) {
+				if (text.empty())
+					continue;
+
+				ConditionSyntax::Condition condition;
+				if (!ConditionSyntax::Parse(text, condition)) {
+					// the plugin stops at the first condition it can't parse
+					a_entry.errors.push_back("could not parse condition: " + text);
+					break;
+				}
+
+				if (!functions.empty() && !functions.contains(Upper(condition.function))) {
+					a_entry.errors.push_back("did not find condition function: " + condition.function);
+					break;
+				}
+
+				items.push_back(std::move(condition));
+			}
+
+			if (items.empty()) {
+				a_entry.errors.push_back("must have conditions");
+			}
+
+			// an item is only required if it isn't part of an OR group, like Prefilter's requirements
+			for (std::size_t i = 0; i < items.size(); ++i) {
+				if (items[i].isOR) {
+					a_entry.pureAnd = false;
+				} else if (i == 0 || !items[i - 1].isOR) {
+					a_entry.required.insert(Normalize(items[i], refs));
+				}
+			}
+
+			if (file.value("match_pose", false)) {
+				const auto keyBones = file.value("key_bones", std::vector<std::string>{});
+				if (keyBones.empty() || std::ranges::count(keyBones, "")) {
+					a_entry.errors.push_back("match_pose needs named key_bones");
+				}
+			}
+
+			if (frames.empty() && limits.empty()) {
+				a_entry.errors.push_back("no frames nor limits found");
+			}
+
+			for (std::size_t i = 0; i < frames.size(); ++i) {
+				if (frames[i].empty()) {
+					a_entry.errors.push_back("no overrides defined in frame at " + std::to_string(i));
+				}
+				for (const auto& override : frames[i]) {
+					const auto name = override.value("name", std::string{});
+					if (name.empty()) {
+						a_entry.errors.push_back("override with no node found in frame at " + std::to_string(i));
+						break;
+					}
+					if (i == 0) {
+						a_entry.bones.insert(name);
+					}
+				}
+			}
+
+			for (const auto& lim : limits) {
+				const auto name = lim.value("name", std::string{});
+				if (name.empty()) {
+					a_entry.errors.push_back("lim with no node found");
+					break;
+				}
+				a_entry.bones.insert(name);
+			}
+		} catch (std::exception& e) {
+			a_entry.errors.push_back(std::string{ "malformed - " } + e.what());
+		}
+	}
+
+	bool Intersects(const std::set<std::string>& a_lhs, const std::set<std::string>& a_rhs)
+	{
+		auto lhs = a_lhs.begin();
+		auto rhs = a_rhs.begin();
+		while (lhs != a_lhs.end() && rhs != a_rhs.end()) {
+			if (*lhs < *rhs) {
+				++lhs;
+			} else if (*rhs < *lhs) {
+				++rhs;
+			} else {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// a_valid is sorted by decreasing priority
+	std::size_t ReportConflicts(const std::vector<const Entry*>& a_valid)
+	{
+		std::size_t problems = 0;
+
+		for (std::size_t i = 0; i < a_valid.size(); ++i) {
+			const auto& high = *a_valid[i];
+
+			for (std::size_t k = i + 1; k < a_valid.size(); ++k) {
+				const auto& low = *a_valid[k];
+				if (!Intersects(high.bones, low.bones))
+					continue;
+
+				if (high.priority == low.priority) {
+					std::printf("warning: %s and %s share bones at priority %llu, their order is unspecified\n",
+						high.path.string().c_str(), low.path.string().c_str(), static_cast<unsigned long long>(high.priority));
+					problems += 1;
+				} else if (high.pureAnd && !high.required.empty() && std::ranges::includes(low.required, high.required)) {
+					// every item of the higher one is required by the lower one, whenever the lower one passes the
+					// higher one passes too and claims the shared bones
+					std::printf("warning: %s is shadowed by %s and can only be selected if the latter is blocked\n",
+						low.path.string().c_str(), high.path.string().c_str());
+					problems += 1;
+				}
+			}
+		}
+
+		return problems;
+	}
+
+	bool WriteBundle(const fs::path& a_dir, const std::vector<Entry>& a_entries)
+	{
+		json files = json::array();
+		for (const auto& entry : a_entries) {
+			files.push_back(json{
+				{ "file", entry.path.filename().string() },
+				{ "size", entry.bytes.size() },
+				{ "mtime", entry.mtime },
+				{ "hash", Bundle::Hash(entry.bytes.data(), entry.bytes.size()) },
+				{ "data", entry.file ? json::binary(json::to_msgpack(*entry.file)) : json{} } });
+		}
+
+		const json bundle{
+			{ "version", Bundle::VERSION },
+			{ "files", std::move(files) }
+		};
+
+		const auto bytes = json::to_msgpack(bundle);
+		const auto path = a_dir / Bundle::NAME;
+
+		std::ofstream file{ path, std::ios::binary };
+		if (!file.is_open()) {
+			std::printf("error: failed to write bundle %s\n", path.string().c_str());
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+		std::printf("wrote bundle %s with %zu files (%zu KiB)\n", path.string().c_str(), a_entries.size(), bytes.size() / 1024);
+
+		return true;
+	}
+
+	// the .json files of a directory, read but not validated yet
+	std::optional<std::vector<Entry>> ReadDir(const fs::path& a_dir)
+	{
+		if (!fs::is_directory(a_dir)) {
+			std::printf("error: %s is not a directory\n", a_dir.string().c_str());
+			return std::nullopt;
+		}
+
+		std::vector<Entry> entries;
+		for (const auto& file : fs::directory_iterator(a_dir)) {
+			if (file.is_directory() || file.path().extension() != ".json")
+				continue;
+
+			auto& entry = entries.emplace_back();
+			entry.path = file.path();
+
+			// taken before reading, a write in between leaves the bundle stale instead of wrong
+			entry.mtime = Bundle::WriteTime(file.path());
+			std::ifstream stream{ file.path(), std::ios::binary };
+			entry.bytes.assign(std::istreambuf_iterator<char>{ stream }, std::istreambuf_iterator<char>{});
+		}
+
+		std::ranges::sort(entries, {}, &Entry::path);
+
+		return entries;
+	}
+
+	// every entry is independent, the workers only share the read-only function list
+	void ValidateAll(const std::vector<Entry*>& a_entries)
+	{
+		const auto workers = std::max(1u, std::thread::hardware_concurrency());
+
+		std::atomic<std::size_t> next = 0;
+		std::vector<std::future<void>> futures;
+		for (unsigned i = 0; i < workers; ++i) {
+			futures.push_back(std::async(std::launch::async, [&]() {
+				for (auto index = next++; index < a_entries.size(); index = next++) {
+					Validate(*a_entries[index]);
+				}
+			}));
+		}
+
+		for (auto& future : futures) {
+			future.get();
+		}
+	}
+
+	std::size_t ReportDir(const fs::path& a_dir, const std::vector<Entry>& a_entries, bool a_pack)
+	{
+		std::size_t problems = 0;
+		std::vector<const Entry*> valid;
+
+		for (const auto& entry : a_entries) {
+			for (const auto& error : entry.errors) {
+				std::printf("error: %s: %s\n", entry.path.string().c_str(), error.c_str());
+			}
+
+			problems += entry.errors.size();
+			if (entry.errors.empty()) {
+				valid.push_back(std::addressof(entry));
+			}
+		}
+
+		std::ranges::stable_sort(valid, [](const Entry* a, const Entry* b) {
+			return a->priority > b->priority;
+		});
+
+		problems += ReportConflicts(valid);
+
+		std::printf("validated %s: %zu files, %zu valid\n", a_dir.string().c_str(), a_entries.size(), valid.size());
+
+		if (a_pack && problems) {
+			// the plugin would take a bundle of a broken directory as is, it has to be fixed first
+			std::printf("error: not packing %s, it has %zu problems\n", a_dir.string().c_str(), problems);
+		} else if (a_pack && !a_entries.empty()) {
+			// every file is listed, the plugin ignores a bundle that doesn't cover its whole directory
+			problems += WriteBundle(a_dir, a_entries) ? 0 : 1;
+		}
+
+		return problems;
+	}
+}
+
+int main(int a_argc, char** a_argv)
+{
+	bool pack = false;
+	std::vector<fs::path> dirs;
+
+	for (int i = 1; i < a_argc; ++i) {
+		const std::string arg{ a_argv[i] };
+		if (arg == "--pack") {
+			pack = true;
+		} else if (arg == "--functions" && i + 1 < a_argc) {
+			std::ifstream list{ a_argv[++i] };
+			for (std::string name; std::getline(list, name);) {
+				if (!name.empty() && name.back() == '\r') {
+					name.pop_back();
+				}
+				if (!name.empty()) {
+					functions.insert(Upper(name));
+				}
+			}
+		} else {
+			dirs.emplace_back(arg);
+		}
+	}
+
+	if (dirs.empty()) {
+		std::printf("usage: %s [--pack] [--functions <file>] <replacer dir>...\n", a_argv[0]);
+		return 2;
+	}
+
+	std::size_t problems = 0;
+
+	// files of all directories are validated in parallel, the report follows the order of the arguments
+	std::vector<std::optional<std::vector<Entry>>> read;
+	std::vector<Entry*> entries;
+	for (const auto& dir : dirs) {
+		auto& files = read.emplace_back(ReadDir(dir));
+		problems += files ? 0 : 1;
+	}
+	for (auto& files : read) {
+		if (files) {
+			std::ranges::transform(*files, std::back_inserter(entries), [](Entry& a_entry) { return std::addressof(a_entry); });
+		}
+	}
+
+	ValidateAll(entries);
+
+	for (std::size_t i = 0; i < dirs.size(); ++i) {
+		if (read[i]) {
+			problems += ReportDir(dirs[i], *read[i], pack);
+		}
+	}
+
+	std::printf("validation finished: %zu directories, %zu problems\n", dirs.size(), problems);
+
+	return problems ? 1 : 0;
+}